@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include "../instrument/instrument.h"
+
+template<class... OBJs>
+struct chain_of_responsibility {
+
+    bool process(std::string_view arg) {
+        return std::apply([&](auto&... tuples){
+            std::size_t index {0};
+            return (instrument::policy::measure<chain_of_responsibility, OBJs...>(index++, [&]{ return tuples(arg); }) || ...);
+        }, m_objects);
+
+    }
+
+private:
+    std::tuple<OBJs...> m_objects;
+};
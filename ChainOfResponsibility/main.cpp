@@ -1,6 +1,6 @@
 #include <iostream>
-#include <tuple>
 #include <string_view>
+#include "chain_of_responsibility.h"
 
 struct proc_text_run {
     bool operator()(std::string_view arg) {
@@ -25,20 +25,6 @@ struct proc_text_busy {
 };
 
 
-template<class... OBJs>
-struct chain_of_responsibility {
-
-    bool process(std::string_view arg) {
-        return std::apply([&](auto&... tuples){
-            return (tuples(arg) || ...);
-        }, m_objects);
-
-    }
-
-private:
-    std::tuple<OBJs...> m_objects;
-};
-
 using chain_t = chain_of_responsibility<proc_text_run, proc_text_stop, proc_text_busy>;
 
 int main()
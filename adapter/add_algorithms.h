@@ -0,0 +1,356 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include "lazy_pipeline.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+namespace execution {
+    struct sequenced_policy {};
+
+    struct parallel_policy {
+        thread_pool *pool {nullptr};
+
+        parallel_policy on(thread_pool &t_pool) const { return {&t_pool}; }
+    };
+
+    struct parallel_unsequenced_policy {
+        thread_pool *pool {nullptr};
+
+        parallel_unsequenced_policy on(thread_pool &t_pool) const { return {&t_pool}; }
+    };
+
+    inline constexpr sequenced_policy seq{};
+    inline constexpr parallel_policy par{};
+    inline constexpr parallel_unsequenced_policy par_unseq{};
+
+    template<class T>
+    concept IsPolicy = std::same_as<T, sequenced_policy>
+                    || std::same_as<T, parallel_policy>
+                    || std::same_as<T, parallel_unsequenced_policy>;
+
+    template<class T>
+    concept IsParallel = std::same_as<T, parallel_policy>
+                      || std::same_as<T, parallel_unsequenced_policy>;
+}
+
+namespace detail {
+    inline constexpr std::size_t cache_line{64};
+    inline constexpr std::size_t chunks_per_thread{4};
+    inline constexpr std::size_t min_chunk_bytes{16 * 1024};
+
+    // Splits [0, count) into chunks and runs f(begin, end) for each of them on the
+    // pool of the policy. Every chunk but the first starts on a cache line, so
+    // no line is written by two threads.
+    template<class Policy, class It, class F>
+    void for_chunks(const Policy &policy, It first, std::size_t count, F &&f)
+    {
+        using value_type = typename std::iterator_traits<It>::value_type;
+        static_assert(std::random_access_iterator<It>, "parallel algorithms need random access iterators");
+
+        auto &pool = policy.pool ? *policy.pool : thread_pool::instance();
+        const std::size_t line = std::max<std::size_t>(1, cache_line / sizeof(value_type));
+        const std::size_t min_chunk = std::max<std::size_t>(line, min_chunk_bytes / sizeof(value_type));
+
+        std::size_t head{0};
+        if constexpr (std::contiguous_iterator<It>) {
+            const auto address = reinterpret_cast<std::uintptr_t>(std::to_address(first));
+            if (address % sizeof(value_type) == 0)
+                head = ((cache_line - address % cache_line) % cache_line) / sizeof(value_type) % line;
+        }
+
+        std::size_t chunk = count / (pool.size() * chunks_per_thread);
+        chunk = std::max(min_chunk, (chunk + line - 1) / line * line);
+        if (head >= count || pool.size() == 1) {
+            f(std::size_t{0}, count);
+            return;
+        }
+
+        const std::size_t tasks = std::max<std::size_t>(1, (count - head + chunk - 1) / chunk);
+        pool.run(tasks, [&](std::size_t task) {
+            const std::size_t begin = task == 0 ? 0 : head + task * chunk;
+            const std::size_t end = task + 1 == tasks ? count : head + (task + 1) * chunk;
+            f(begin, end);
+        });
+    }
+}
+
+template<class Container>
+struct add_algorithms: Container {
+
+    template<class F>
+    auto &for_each(F &&f)
+    {
+        auto p = static_cast<Container *>(this);
+        if constexpr (IsWindowed<Container>) {
+            p->for_each_window([&](auto first, auto last, std::size_t) {
+                for (; first != last; ++first)
+                    f(*first);
+            });
+        }
+        else {
+            std::for_each(p->begin(), p->end(), f);
+        }
+        return *this;
+    }
+
+    template<execution::IsPolicy Policy, class F>
+    auto &for_each(const Policy &policy, F &&f)
+    {
+        if constexpr (execution::IsParallel<Policy>) {
+            for_each_parallel_block([&](auto first, std::size_t count, std::size_t) {
+                detail::for_chunks(policy, first, count, [&](std::size_t begin, std::size_t end) {
+                    if constexpr (std::is_same_v<Policy, execution::parallel_unsequenced_policy>) {
+                        SIMD_KERNELS_IVDEP
+                        for (std::size_t i = begin; i < end; ++i)
+                            f(first[i]);
+                    }
+                    else {
+                        for (std::size_t i = begin; i < end; ++i)
+                            f(first[i]);
+                    }
+                });
+            });
+            return *this;
+        }
+        else {
+            return for_each(std::forward<F>(f));
+        }
+    }
+
+    template<class F>
+    auto &for_each_n(F &&f)
+    {
+        auto p = static_cast<Container *>(this);
+        if constexpr (IsWindowed<Container>) {
+            p->for_each_window([&](auto first, auto last, std::size_t i) {
+                for (; first != last; ++first, ++i)
+                    f(*first, i);
+            });
+        }
+        else {
+            auto first = p->begin();
+            auto last = p->end();
+            std::size_t i{0};
+            for (; first != last; ++first, ++i)
+                f(*first, i);
+        }
+        return *this;
+    }
+
+    // the index is the position in the container, whatever chunk the element falls into
+    template<execution::IsPolicy Policy, class F>
+    auto &for_each_n(const Policy &policy, F &&f)
+    {
+        if constexpr (execution::IsParallel<Policy>) {
+            for_each_parallel_block([&](auto first, std::size_t count, std::size_t base) {
+                detail::for_chunks(policy, first, count, [&](std::size_t begin, std::size_t end) {
+                    if constexpr (std::is_same_v<Policy, execution::parallel_unsequenced_policy>) {
+                        SIMD_KERNELS_IVDEP
+                        for (std::size_t i = begin; i < end; ++i)
+                            f(first[i], base + i);
+                    }
+                    else {
+                        for (std::size_t i = begin; i < end; ++i)
+                            f(first[i], base + i);
+                    }
+                });
+            });
+            return *this;
+        }
+        else {
+            return for_each_n(std::forward<F>(f));
+        }
+    }
+
+    auto &reverse()
+    {
+        auto p = static_cast<Container *>(this);
+        if constexpr (IsWindowed<Container>) {
+            p->reverse_windows();
+        }
+        else if constexpr (simd::IsArithmeticRange<Container>) {
+            simd::reverse(std::ranges::data(*p), std::ranges::size(*p));
+        }
+        else {
+            auto first = p->begin();
+            auto last = p->end();
+            std::reverse(first, last);
+        }
+        return *this;
+    }
+
+    // the front half is split into chunks, each chunk swaps with its mirror in the back half
+    template<execution::IsPolicy Policy>
+    auto &reverse(const Policy &policy)
+    {
+        if constexpr (execution::IsParallel<Policy> && IsWindowed<Container>) {
+            // one pair of mirrored windows at a time, split into chunks
+            static_cast<Container *>(this)->reverse_windows([&](auto first, auto last, auto mirror) {
+                detail::for_chunks(policy, first, std::size_t(last - first), [&](std::size_t begin, std::size_t end) {
+                    using std::swap;
+                    for (std::size_t i = begin; i < end; ++i)
+                        swap(first[i], mirror[-1 - std::ptrdiff_t(i)]);
+                });
+            });
+            return *this;
+        }
+        else if constexpr (execution::IsParallel<Policy>) {
+            auto p = static_cast<Container *>(this);
+            auto first = p->begin();
+            const std::size_t count = p->end() - first;
+            detail::for_chunks(policy, first, count / 2, [&](std::size_t begin, std::size_t end) {
+                using std::swap;
+                for (std::size_t i = begin; i < end; ++i)
+                    swap(first[i], first[count - 1 - i]);
+            });
+            return *this;
+        }
+        else {
+            return reverse();
+        }
+    }
+
+    // value = f(value)
+    template<class F>
+    auto &transform(F &&f)
+    {
+        auto p = static_cast<Container *>(this);
+        if constexpr (simd::IsArithmeticRange<Container>) {
+            for_each_block([&](auto first, auto last, std::size_t) {
+                simd::transform(first, std::size_t(last - first), f);
+            });
+        }
+        else {
+            for (auto &value : *p)
+                value = f(value);
+        }
+        return *this;
+    }
+
+    // value = f(value, index)
+    template<class F>
+    auto &transform_n(F &&f)
+    {
+        auto p = static_cast<Container *>(this);
+        if constexpr (simd::IsArithmeticRange<Container>) {
+            for_each_block([&](auto first, auto last, std::size_t base) {
+                auto shifted = [&](auto value, std::size_t index) { return f(value, base + index); };
+                simd::transform_n(first, std::size_t(last - first), shifted);
+            });
+        }
+        else {
+            std::size_t i{0};
+            for (auto &value : *p)
+                value = f(value, i++);
+        }
+        return *this;
+    }
+
+    template<class T, class Op = std::plus<>>
+    T reduce(T init, Op op = {})
+    {
+        auto p = static_cast<Container *>(this);
+        using value_type = std::ranges::range_value_t<Container>;
+        if constexpr (simd::IsArithmeticRange<Container> && simd::IsKernelType<value_type>
+                      && std::is_same_v<T, value_type> && simd::IsPlus<Op, T>) {
+            for_each_block([&](auto first, auto last, std::size_t) {
+                init += simd::sum(first, std::size_t(last - first));
+            });
+            return init;
+        }
+        else if constexpr (IsWindowed<Container>) {
+            for_each_block([&](auto first, auto last, std::size_t) {
+                init = std::accumulate(first, last, std::move(init), op);
+            });
+            return init;
+        }
+        else {
+            return std::accumulate(p->begin(), p->end(), std::move(init), op);
+        }
+    }
+
+    // the container must not be empty
+    auto minmax()
+    {
+        auto p = static_cast<Container *>(this);
+        using value_type = std::ranges::range_value_t<Container>;
+        if constexpr (simd::IsArithmeticRange<Container> && simd::IsKernelType<value_type>) {
+            std::pair<value_type, value_type> result{};
+            for_each_block([&](auto first, auto last, std::size_t base) {
+                const auto [min, max] = simd::minmax(first, std::size_t(last - first));
+                result.first = base == 0 ? min : std::min(result.first, min);
+                result.second = base == 0 ? max : std::max(result.second, max);
+            });
+            return result;
+        }
+        else if constexpr (IsWindowed<Container>) {
+            std::pair<value_type, value_type> result{};
+            for_each_block([&](auto first, auto last, std::size_t base) {
+                const auto [min, max] = std::minmax_element(first, last);
+                result.first = base == 0 ? *min : std::min(result.first, *min);
+                result.second = base == 0 ? *max : std::max(result.second, *max);
+            });
+            return result;
+        }
+        else {
+            auto [min, max] = std::minmax_element(p->begin(), p->end());
+            return std::pair<value_type, value_type>{*min, *max};
+        }
+    }
+
+    // map/filter/for_each/reverse recorded here are fused into one pass by run(),
+    // windowed containers are walked window by window
+    auto lazy()
+    {
+        return lazy_pipeline<add_algorithms, false>{*this, {}};
+    }
+
+    template<class F>
+    auto &then(F &&f)
+    {
+        f(*this);
+        return *this;
+    }
+
+private:
+    // random access storage as f(first, count, index of first) for the parallel
+    // algorithms: per window, so a windowed container is never walked as a whole
+    template<class F>
+    void for_each_parallel_block(F &&f)
+    {
+        auto p = static_cast<Container *>(this);
+        if constexpr (IsWindowed<Container>) {
+            p->for_each_window([&](auto first, auto last, std::size_t base) {
+                f(first, std::size_t(last - first), base);
+            });
+        }
+        else {
+            auto first = p->begin();
+            f(first, std::size_t(p->end() - first), std::size_t{0});
+        }
+    }
+
+    // contiguous storage as f(first, last, index of first): per window or all at once
+    template<class F>
+    void for_each_block(F &&f)
+    {
+        auto p = static_cast<Container *>(this);
+        if constexpr (IsWindowed<Container>) {
+            p->for_each_window(f);
+        }
+        else {
+            auto first = std::ranges::data(*p);
+            f(first, first + std::ranges::size(*p), std::size_t{0});
+        }
+    }
+};
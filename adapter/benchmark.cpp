@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "add_algorithms.h"
+
+template<class T>
+using my_vector = add_algorithms<std::vector<T>>;
+
+// best of several runs, milliseconds
+template<class F>
+double measure(F &&f, int runs = 5)
+{
+    double best{1e300};
+    for (int i{0}; i < runs; ++i) {
+        const auto begin = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> spent = std::chrono::steady_clock::now() - begin;
+        best = std::min(best, spent.count());
+    }
+    return best;
+}
+
+// for_each, for_each_n and reverse with 1..N threads against the sequential form
+void scaling(std::size_t count)
+{
+    const std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    my_vector<float> values;
+    values.resize(count, 1.0f);
+
+    const auto seq_for_each = measure([&] { values.for_each(execution::seq, [](auto &value) { value = value * 1.0001f + 1.0f; }); });
+    const auto seq_for_each_n = measure([&] { values.for_each_n(execution::seq, [](auto &value, auto index) { value += float(index & 7); }); });
+    const auto seq_reverse = measure([&] { values.reverse(execution::seq); });
+
+    std::cout << "elements: " << count << std::endl;
+    std::cout << std::setw(8) << "threads"
+              << std::setw(14) << "for_each ms" << std::setw(10) << "speedup"
+              << std::setw(16) << "for_each_n ms" << std::setw(10) << "speedup"
+              << std::setw(14) << "reverse ms" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::setw(8) << "seq"
+              << std::setw(14) << seq_for_each << std::setw(10) << 1.0
+              << std::setw(16) << seq_for_each_n << std::setw(10) << 1.0
+              << std::setw(14) << seq_reverse << std::setw(10) << 1.0 << std::endl;
+
+    // powers of two, then all cores
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t threads{1}; threads <= max_threads; threads *= 2)
+        thread_counts.push_back(threads);
+    if (thread_counts.back() != max_threads)
+        thread_counts.push_back(max_threads);
+
+    for (const auto threads : thread_counts) {
+        thread_pool pool{threads};
+        const auto policy = execution::par_unseq.on(pool);
+
+        const auto for_each = measure([&] { values.for_each(policy, [](auto &value) { value = value * 1.0001f + 1.0f; }); });
+        const auto for_each_n = measure([&] { values.for_each_n(policy, [](auto &value, auto index) { value += float(index & 7); }); });
+        const auto reverse = measure([&] { values.reverse(execution::par.on(pool)); });
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(14) << for_each << std::setw(10) << seq_for_each / for_each
+                  << std::setw(16) << for_each_n << std::setw(10) << seq_for_each_n / for_each_n
+                  << std::setw(14) << reverse << std::setw(10) << seq_reverse / reverse << std::endl;
+    }
+}
+
+// map -> reverse -> indexed sum: three eager passes against one fused lazy pass,
+// the lazy form leaves the container untouched
+void fusion(std::size_t count)
+{
+    my_vector<float> values;
+    values.resize(count, 1.0f);
+
+    double eager_sum{0};
+    const auto eager = measure([&] {
+        eager_sum = 0;
+        values.for_each([](auto &value) { value = value * 0.5f + 1.0f; })
+              .reverse()
+              .for_each_n([&](auto value, auto index) { eager_sum += value * float(index & 3); });
+    });
+
+    double lazy_sum{0};
+    const auto lazy = measure([&] {
+        lazy_sum = 0;
+        values.lazy()
+              .map([](auto value) { return value * 0.5f + 1.0f; })
+              .reverse()
+              .for_each_n([&](auto value, auto index) { lazy_sum += value * float(index & 3); })
+              .run();
+    });
+
+    std::cout << std::endl << "elements: " << count << " (" << count * sizeof(float) / (1024 * 1024) << " MiB)" << std::endl;
+    std::cout << std::setw(8) << "eager" << std::setw(14) << eager << " ms" << std::endl;
+    std::cout << std::setw(8) << "lazy" << std::setw(14) << lazy << " ms" << std::setw(10) << eager / lazy << "x" << std::endl;
+    if (eager_sum < 0 || lazy_sum < 0)
+        std::cout << "unexpected sum" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{1} << 25;
+
+    scaling(count);
+    fusion(count);
+
+    return 0;
+}
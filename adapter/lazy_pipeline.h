@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Containers too large for memory (see mapped_array.h) hand out their storage
+// window by window; the sequential algorithms then never walk it as a whole.
+template<class C>
+concept IsWindowed = requires(C container) {
+    container.for_each_window([](auto *, auto *, std::size_t) {});
+    container.for_each_window_backward([](auto *, auto *, std::size_t) {});
+    container.reverse_windows();
+};
+
+namespace stage {
+    enum class kind {
+        map,
+        filter,
+        for_each,
+        for_each_n
+    };
+
+    // Reversed - an odd number of reverse() calls precedes the stage
+    template<kind K, class F, bool Reversed>
+    struct stage {
+        static constexpr kind type = K;
+        static constexpr bool reversed = Reversed;
+        F f;
+    };
+
+    template<class F, bool R> using map        = stage<kind::map, F, R>;
+    template<class F, bool R> using filter     = stage<kind::filter, F, R>;
+    template<class F, bool R> using for_each   = stage<kind::for_each, F, R>;
+    template<class F, bool R> using for_each_n = stage<kind::for_each_n, F, R>;
+}
+
+// Records stages and runs all of them in one pass over the container, element
+// by element. reverse() affects only the stages recorded after it: every stage
+// sees each element paired with the index it has in the eager chain, so
+// for_each_n(f).reverse().for_each_n(g) passes the same (value, index) pairs to
+// f and g as the eager form. The pass itself goes in the direction of the last
+// stages and of reduce(); stages before an odd number of reverse() calls see
+// their elements in the opposite order. Until the first map the stages get a
+// reference to the element itself and may modify it.
+template<class Self, bool Reversed, class... Stages>
+class lazy_pipeline {
+public:
+    lazy_pipeline(Self &self, std::tuple<Stages...> stages) : m_self{&self}, m_stages{std::move(stages)}
+    {}
+
+    template<class F>
+    auto map(F &&f) { return append<stage::map<std::decay_t<F>, Reversed>>(std::forward<F>(f)); }
+
+    template<class F>
+    auto filter(F &&f) { return append<stage::filter<std::decay_t<F>, Reversed>>(std::forward<F>(f)); }
+
+    template<class F>
+    auto for_each(F &&f) { return append<stage::for_each<std::decay_t<F>, Reversed>>(std::forward<F>(f)); }
+
+    // the index is the position of the element in the container as reversed at
+    // this stage; filters before the stage do not make it dense
+    template<class F>
+    auto for_each_n(F &&f) { return append<stage::for_each_n<std::decay_t<F>, Reversed>>(std::forward<F>(f)); }
+
+    auto reverse()
+    {
+        return lazy_pipeline<Self, !Reversed, Stages...>{*m_self, std::move(m_stages)};
+    }
+
+    Self &run()
+    {
+        drive([](auto &&) {});
+        return *m_self;
+    }
+
+    template<class T, class Op>
+    T reduce(T init, Op op)
+    {
+        drive([&](auto &&value) { init = op(std::move(init), std::forward<decltype(value)>(value)); });
+        return init;
+    }
+
+private:
+    template<class Stage, class F>
+    auto append(F &&f)
+    {
+        return lazy_pipeline<Self, Reversed, Stages..., Stage>{
+            *m_self, std::tuple_cat(std::move(m_stages), std::tuple<Stage>{Stage{std::forward<F>(f)}})};
+    }
+
+    template<class Sink>
+    void drive(Sink &&sink)
+    {
+        if constexpr (IsWindowed<Self>) {
+            m_size = m_self->size();
+            auto t_sweep = [&](auto first, auto last, std::size_t base) {
+                sweep(first, last, base, base + std::size_t(last - first), sink);
+            };
+            if constexpr (Reversed)
+                m_self->for_each_window_backward(t_sweep);
+            else
+                m_self->for_each_window(t_sweep);
+        }
+        else {
+            m_size = static_cast<std::size_t>(std::distance(m_self->begin(), m_self->end()));
+            sweep(m_self->begin(), m_self->end(), 0, m_size, sink);
+        }
+    }
+
+    // [first, last) holds the elements at positions [begin, end) of the original order
+    template<class It, class Sink>
+    void sweep(It first, It last, std::size_t begin, std::size_t end, Sink &sink)
+    {
+        if constexpr (Reversed) {
+            for (std::size_t position{end}; last != first; ) {
+                --last;
+                push<0>(*last, --position, sink);
+            }
+        }
+        else {
+            for (std::size_t position{begin}; first != last; ++first)
+                push<0>(*first, position++, sink);
+        }
+    }
+
+    template<std::size_t I, class V, class Sink>
+    void push(V &&value, std::size_t position, Sink &sink)
+    {
+        if constexpr (I == sizeof...(Stages)) {
+            sink(std::forward<V>(value));
+        }
+        else {
+            auto &t_stage = std::get<I>(m_stages);
+            using stage_t = std::decay_t<decltype(t_stage)>;
+            if constexpr (stage_t::type == stage::kind::map) {
+                push<I + 1>(t_stage.f(std::forward<V>(value)), position, sink);
+            }
+            else if constexpr (stage_t::type == stage::kind::filter) {
+                if (t_stage.f(value))
+                    push<I + 1>(std::forward<V>(value), position, sink);
+            }
+            else if constexpr (stage_t::type == stage::kind::for_each) {
+                t_stage.f(value);
+                push<I + 1>(std::forward<V>(value), position, sink);
+            }
+            else {
+                t_stage.f(value, stage_t::reversed ? m_size - 1 - position : position);
+                push<I + 1>(std::forward<V>(value), position, sink);
+            }
+        }
+    }
+
+    Self *m_self;
+    std::tuple<Stages...> m_stages;
+    std::size_t m_size{0};
+};
@@ -1,51 +1,20 @@
-#include <algorithm>
 #include <array>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
-
-template<class Container>
-struct add_algorithms: Container {
-
-    template<class F>
-    auto &for_each(F &&f)
-    {
-        auto p = static_cast<Container *>(this);
-        std::for_each(p->begin(), p->end(), f);
-        return *this;
-    }
-
-    template<class F>
-    auto &for_each_n(F &&f)
-    {
-        auto p = static_cast<Container *>(this);
-        auto first = p->begin();
-        auto last = p->end();
-        std::size_t i{0};
-        for (; first != last; ++first, ++i)
-            f(*first, i);
-        return *this;
-    }
-
-    auto &reverse()
-    {
-        auto p = static_cast<Container *>(this);
-        auto first = p->begin();
-        auto last = p->end();
-        std::reverse(first, last);
-        return *this;
-    }
-
-    template<class F>
-    auto &then(F &&f)
-    {
-        f(*this);
-        return *this;
-    }
-};
-
+#include <vector>
+#include "add_algorithms.h"
+#include "mapped_array.h"
 
 template<class T, std::size_t N>
 using my_array = add_algorithms<std::array<T, N>>;
 
+template<class T>
+using my_vector = add_algorithms<std::vector<T>>;
+
+template<class T>
+using my_mapped = add_algorithms<mapped_array<T>>;
+
 
 int main(int argc, char *argv[])
 {
@@ -62,5 +31,52 @@ int main(int argc, char *argv[])
         std::cout << "value: " << value << ", index: " << index << std::endl;
     });
 
+    my_vector<long> t_vector;
+    t_vector.resize(1 << 20);
+    t_vector.for_each_n(execution::par, [](auto &value, auto index) {
+        value = static_cast<long>(index);
+    })
+    .reverse(execution::par)
+    .for_each(execution::par_unseq, [](auto &value) {
+        value *= 2;
+    })
+    .then([](auto &values) {
+        std::cout << "front: " << values.front() << ", back: " << values.back() << std::endl;
+    });
+
+    auto sum = t_array.lazy()
+                   .map([](auto value) { return value * 10; })
+                   .filter([](auto value) { return value > 10; })
+                   .reverse()
+                   .for_each_n([](auto value, auto index) { // index in the reversed array, filtered out ones leave gaps
+                       std::cout << "lazy value: " << value << ", index: " << index << std::endl;
+                   })
+                   .reduce(0, [](auto acc, auto value) { return acc + value; });
+    std::cout << "sum: " << sum << std::endl;
+
+    my_vector<float> t_floats;
+    t_floats.resize(1000);
+    auto [min, max] = t_floats.transform_n([](auto, auto index) { return float(index) - 500.0f; })
+                              .transform([](auto value) { return value * 0.5f; })
+                              .reverse()
+                              .minmax();
+    std::cout << "min: " << min << ", max: " << max << ", front: " << t_floats.front()
+              << ", sum: " << t_floats.reduce(0.0f) << std::endl;
+
+    // 4 MiB file walked through 64 KiB windows
+    const auto path = std::filesystem::temp_directory_path() / "adapter_mapped_array.bin";
+    {
+        my_mapped<int> t_mapped{mapped_array<int>{path.c_str(), 1 << 20, 64 * 1024}};
+        if (t_mapped.is_open()) {
+            auto [t_min, t_max] = t_mapped.for_each_n([](auto &value, auto index) { value = static_cast<int>(index); })
+                                          .reverse()
+                                          .transform([](auto value) { return value - 1; })
+                                          .minmax();
+            std::cout << "mapped front: " << t_mapped[0] << ", min: " << t_min << ", max: " << t_max
+                      << ", sum: " << t_mapped.reduce(0L, [](long acc, int value) { return acc + value; }) << std::endl;
+        }
+    }
+    std::filesystem::remove(path);
+
     return 0;
 }
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Faults pages of the windows ahead in on a background thread while the
+// current window is processed. Only the latest request is kept: a new one
+// replaces the pending ranges and abandons the ones in progress, so windows the
+// walker has reached or released are not mapped in again. The pages are
+// faulted in by the kernel, the thread never reads the mapping itself.
+class prefetcher {
+public:
+    struct range {
+        const char *address;
+        std::size_t bytes;
+    };
+
+    prefetcher() : m_thread{[this] { work(); }}
+    {}
+
+    prefetcher(const prefetcher &) = delete;
+    prefetcher &operator=(const prefetcher &) = delete;
+
+    ~prefetcher()
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    // an empty request only cancels the previous one
+    void request(range first, range second = {nullptr, 0})
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_pending = {first, second};
+            m_generation.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_wake.notify_one();
+    }
+
+private:
+    static constexpr std::size_t chunk_bytes{256 * 1024};
+
+    void work()
+    {
+        const std::size_t page = sysconf(_SC_PAGESIZE);
+        std::uint64_t done{0};
+        std::unique_lock lock{m_mutex};
+        for (;;) {
+            m_wake.wait(lock, [&] { return m_stop || m_generation.load(std::memory_order_relaxed) != done; });
+            if (m_stop)
+                return;
+            done = m_generation.load(std::memory_order_relaxed);
+            const auto ranges = m_pending;
+            lock.unlock();
+
+            for (const auto &[address, bytes] : ranges) {
+                const auto begin = reinterpret_cast<std::uintptr_t>(address) / page * page;
+                const auto end = reinterpret_cast<std::uintptr_t>(address) + bytes;
+                for (auto first = begin; first < end && m_generation.load(std::memory_order_relaxed) == done; first += chunk_bytes) {
+                    const auto length = std::min<std::uintptr_t>(chunk_bytes, end - first);
+                    madvise(reinterpret_cast<void *>(first), length, MADV_WILLNEED);
+#if defined(MADV_POPULATE_READ)
+                    madvise(reinterpret_cast<void *>(first), length, MADV_POPULATE_READ);
+#endif
+                }
+            }
+
+            lock.lock();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::array<range, 2> m_pending{};
+    std::atomic<std::uint64_t> m_generation{0};
+    bool m_stop{false};
+    std::thread m_thread;
+};
+
+// Array of T stored in a file and mapped with mmap. The fluent algorithms walk
+// it through for_each_window(), one bounded window at a time: the next window
+// is prefetched in the background, a finished window is written back and
+// dropped from the process, so the file is never resident as a whole.
+template<class T>
+class mapped_array {
+    static_assert(std::is_trivially_copyable_v<T>, "mapped_array needs trivially copyable elements");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    static constexpr std::size_t default_window_bytes{64 * 1024 * 1024};
+
+    // count != 0 creates the file or resizes it to count elements
+    explicit mapped_array(const char *path, std::size_t count = 0, std::size_t window_bytes = default_window_bytes)
+    {
+        m_fd = ::open(path, O_RDWR | O_CREAT, 0644);
+        if (m_fd < 0)
+            return;
+
+        if (count != 0 && ftruncate(m_fd, off_t(count * sizeof(T))) != 0) {
+            close();
+            return;
+        }
+        struct stat t_stat{};
+        if (fstat(m_fd, &t_stat) != 0) {
+            close();
+            return;
+        }
+        m_size = std::size_t(t_stat.st_size) / sizeof(T);
+
+        const std::size_t page = sysconf(_SC_PAGESIZE);
+        const std::size_t bytes = std::max(page, window_bytes / page * page);
+        m_window = std::max<std::size_t>(1, bytes / sizeof(T));
+
+        if (m_size != 0) {
+            void *memory = mmap(nullptr, m_size * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if (memory == MAP_FAILED) {
+                close();
+                return;
+            }
+            m_data = static_cast<T *>(memory);
+        }
+        m_prefetcher = std::make_unique<prefetcher>();
+    }
+
+    mapped_array(mapped_array &&other) noexcept
+        : m_fd{std::exchange(other.m_fd, -1)}
+        , m_data{std::exchange(other.m_data, nullptr)}
+        , m_size{std::exchange(other.m_size, 0)}
+        , m_window{other.m_window}
+        , m_prefetcher{std::move(other.m_prefetcher)}
+    {}
+
+    mapped_array &operator=(mapped_array &&other) noexcept
+    {
+        if (this != &other) {
+            close();
+            m_fd = std::exchange(other.m_fd, -1);
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_window = other.m_window;
+            m_prefetcher = std::move(other.m_prefetcher);
+        }
+        return *this;
+    }
+
+    ~mapped_array()
+    {
+        close();
+    }
+
+    [[nodiscard]] bool is_open() const noexcept { return m_fd >= 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] std::size_t window() const noexcept { return m_window; }
+
+    T *data() noexcept { return m_data; }
+    const T *data() const noexcept { return m_data; }
+    T *begin() noexcept { return m_data; }
+    T *end() noexcept { return m_data + m_size; }
+    const T *begin() const noexcept { return m_data; }
+    const T *end() const noexcept { return m_data + m_size; }
+    T &operator[](std::size_t index) noexcept { return m_data[index]; }
+    const T &operator[](std::size_t index) const noexcept { return m_data[index]; }
+
+    // calls f(first, last, index of first) for every window in order
+    template<class F>
+    void for_each_window(F &&f)
+    {
+        for (std::size_t base{0}; base < m_size; base += m_window) {
+            const auto count = std::min(m_window, m_size - base);
+            prefetch(base + count, std::min(m_window, m_size - base - count));
+            f(m_data + base, m_data + base + count, base);
+            release(base, count);
+        }
+    }
+
+    // the same from the last window to the first
+    template<class F>
+    void for_each_window_backward(F &&f)
+    {
+        if (m_size == 0)
+            return;
+        for (std::size_t base{(m_size - 1) / m_window * m_window};; base -= m_window) {
+            const auto count = std::min(m_window, m_size - base);
+            prefetch(base == 0 ? 0 : base - m_window, base == 0 ? 0 : m_window);
+            f(m_data + base, m_data + base + count, base);
+            release(base, count);
+            if (base == 0)
+                break;
+        }
+    }
+
+    // swaps windows of the front half with the mirrored windows of the back half
+    void reverse_windows()
+    {
+        reverse_windows([](T *first, T *last, T *mirror) {
+            std::swap_ranges(first, last, std::reverse_iterator{mirror});
+        });
+    }
+
+    // swap(first, last, mirror) exchanges [first, last) with the window which
+    // ends at mirror, read backwards
+    template<class Swap>
+    void reverse_windows(Swap &&swap)
+    {
+        const auto half = m_size / 2;
+        for (std::size_t front{0}; front < half; front += m_window) {
+            const auto count = std::min(m_window, half - front);
+            const auto back = m_size - front - count;
+            const auto next = std::min(m_window, half - front - count);
+            prefetch(front + count, next, back - next);
+            swap(m_data + front, m_data + front + count, m_data + back + count);
+            release(front, count);
+            release(back, count);
+        }
+    }
+
+    // blocks until the changes are in the file
+    bool flush() noexcept
+    {
+        return m_data == nullptr || msync(m_data, m_size * sizeof(T), MS_SYNC) == 0;
+    }
+
+private:
+    // count elements from first and, if given, from other; replaces the previous prefetch
+    void prefetch(std::size_t first, std::size_t count, std::optional<std::size_t> other = {})
+    {
+        const auto bytes = count * sizeof(T);
+        const auto address = [&](std::size_t index) { return reinterpret_cast<const char *>(m_data + index); };
+        m_prefetcher->request({address(first), bytes}, other ? prefetcher::range{address(*other), bytes} : prefetcher::range{nullptr, 0});
+    }
+
+    // start the write-back and drop the pages from the process, the page cache keeps dirty data
+    void release(std::size_t first, std::size_t count) noexcept
+    {
+        const std::size_t page = sysconf(_SC_PAGESIZE);
+        const auto begin = reinterpret_cast<std::uintptr_t>(m_data + first) / page * page;
+        const auto end = reinterpret_cast<std::uintptr_t>(m_data + first + count);
+        msync(reinterpret_cast<void *>(begin), end - begin, MS_ASYNC);
+        madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+    }
+
+    void close() noexcept
+    {
+        m_prefetcher.reset();
+        if (m_data != nullptr)
+            munmap(m_data, m_size * sizeof(T));
+        if (m_fd >= 0)
+            ::close(m_fd);
+        m_data = nullptr;
+        m_size = 0;
+        m_fd = -1;
+    }
+
+    int m_fd{-1};
+    T *m_data{nullptr};
+    std::size_t m_size{0};
+    std::size_t m_window{1};
+    std::unique_ptr<prefetcher> m_prefetcher;
+};
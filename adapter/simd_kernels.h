@@ -0,0 +1,504 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_KERNELS_X86 1
+#endif
+
+// the iterations of the next loop are independent, also used by add_algorithms
+#if defined(__GNUC__) && !defined(__clang__)
+#define SIMD_KERNELS_IVDEP _Pragma("GCC ivdep")
+#elif defined(__clang__)
+#define SIMD_KERNELS_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#else
+#define SIMD_KERNELS_IVDEP
+#endif
+
+// Vectorized kernels for contiguous arithmetic containers. The instruction set
+// is fixed at compile time when the build already targets it (-mavx2, ...),
+// otherwise it is detected once at run time. reduce, minmax and reverse have
+// hand written kernels for int32_t and float; transform accepts any callable
+// and is compiled once per instruction set, the compiler vectorizes the loop.
+namespace simd {
+
+    enum class isa {
+        scalar,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    inline isa detect() noexcept {
+#if defined(__AVX512F__)
+        return isa::avx512;
+#elif defined(__AVX2__)
+        static const isa t_isa = __builtin_cpu_supports("avx512f") ? isa::avx512 : isa::avx2;
+        return t_isa;
+#elif defined(SIMD_KERNELS_X86)
+        static const isa t_isa = __builtin_cpu_supports("avx512f") ? isa::avx512
+                               : __builtin_cpu_supports("avx2")    ? isa::avx2
+                               : __builtin_cpu_supports("sse2")    ? isa::sse2
+                                                                   : isa::scalar;
+        return t_isa;
+#else
+        return isa::scalar;
+#endif
+    }
+
+    template<class T>
+    concept IsKernelType = std::same_as<T, std::int32_t> || std::same_as<T, float>;
+
+    template<class C>
+    concept IsArithmeticRange = std::ranges::contiguous_range<C>
+                             && std::is_arithmetic_v<std::ranges::range_value_t<C>>;
+
+    template<class Op, class T>
+    concept IsPlus = std::same_as<Op, std::plus<>> || std::same_as<Op, std::plus<T>>;
+
+    namespace scalar {
+        template<class T, class F>
+        void transform(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i]);
+        }
+
+        template<class T, class F>
+        void transform_n(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i], i);
+        }
+
+        template<class T>
+        T sum(const T *data, std::size_t count)
+        {
+            T result{};
+            for (std::size_t i = 0; i < count; ++i)
+                result += data[i];
+            return result;
+        }
+
+        template<class T>
+        std::pair<T, T> minmax(const T *data, std::size_t count)
+        {
+            auto [min, max] = std::minmax_element(data, data + count);
+            return {*min, *max};
+        }
+    }
+
+#if defined(SIMD_KERNELS_X86)
+    namespace sse2 {
+        template<class T, class F>
+        __attribute__((target("sse2"))) void transform(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i]);
+        }
+
+        template<class T, class F>
+        __attribute__((target("sse2"))) void transform_n(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i], i);
+        }
+
+        __attribute__((target("sse2"))) inline float sum(const float *data, std::size_t count)
+        {
+            __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                a0 = _mm_add_ps(a0, _mm_loadu_ps(data + i));
+                a1 = _mm_add_ps(a1, _mm_loadu_ps(data + i + 4));
+            }
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, _mm_add_ps(a0, a1));
+            float result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            for (; i < count; ++i)
+                result += data[i];
+            return result;
+        }
+
+        __attribute__((target("sse2"))) inline std::int32_t sum(const std::int32_t *data, std::size_t count)
+        {
+            __m128i a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                a0 = _mm_add_epi32(a0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+                a1 = _mm_add_epi32(a1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 4)));
+            }
+            alignas(16) std::int32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), _mm_add_epi32(a0, a1));
+            std::uint32_t result = std::uint32_t(lanes[0]) + std::uint32_t(lanes[1]) + std::uint32_t(lanes[2]) + std::uint32_t(lanes[3]);
+            for (; i < count; ++i)
+                result += std::uint32_t(data[i]);
+            return std::int32_t(result);
+        }
+
+        __attribute__((target("sse2"))) inline std::pair<float, float> minmax(const float *data, std::size_t count)
+        {
+            std::size_t i = 0;
+            if (count < 4)
+                return scalar::minmax(data, count);
+            __m128 min = _mm_loadu_ps(data), max = min;
+            for (i = 4; i + 4 <= count; i += 4) {
+                const __m128 value = _mm_loadu_ps(data + i);
+                min = _mm_min_ps(min, value);
+                max = _mm_max_ps(max, value);
+            }
+            alignas(16) float lo[4], hi[4];
+            _mm_store_ps(lo, min);
+            _mm_store_ps(hi, max);
+            auto [t_min, t_max] = std::pair{*std::min_element(lo, lo + 4), *std::max_element(hi, hi + 4)};
+            for (; i < count; ++i) {
+                t_min = std::min(t_min, data[i]);
+                t_max = std::max(t_max, data[i]);
+            }
+            return {t_min, t_max};
+        }
+
+        // SSE2 has no pminsd/pmaxsd, select through a compare mask
+        __attribute__((target("sse2"))) inline __m128i select(__m128i mask, __m128i a, __m128i b)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+
+        __attribute__((target("sse2"))) inline std::pair<std::int32_t, std::int32_t> minmax(const std::int32_t *data, std::size_t count)
+        {
+            std::size_t i = 0;
+            if (count < 4)
+                return scalar::minmax(data, count);
+            __m128i min = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), max = min;
+            for (i = 4; i + 4 <= count; i += 4) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                min = select(_mm_cmplt_epi32(value, min), value, min);
+                max = select(_mm_cmpgt_epi32(value, max), value, max);
+            }
+            alignas(16) std::int32_t lo[4], hi[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lo), min);
+            _mm_store_si128(reinterpret_cast<__m128i *>(hi), max);
+            auto [t_min, t_max] = std::pair{*std::min_element(lo, lo + 4), *std::max_element(hi, hi + 4)};
+            for (; i < count; ++i) {
+                t_min = std::min(t_min, data[i]);
+                t_max = std::max(t_max, data[i]);
+            }
+            return {t_min, t_max};
+        }
+
+        // 4 byte elements, blocks from both ends are swapped with their lanes reversed
+        template<class T>
+        __attribute__((target("sse2"))) void reverse32(T *data, std::size_t count)
+        {
+            static_assert(sizeof(T) == 4);
+            std::size_t front = 0, back = count;
+            for (; front + 8 <= back; front += 4, back -= 4) {
+                const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + front));
+                const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + back - 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(data + front), _mm_shuffle_epi32(hi, _MM_SHUFFLE(0, 1, 2, 3)));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(data + back - 4), _mm_shuffle_epi32(lo, _MM_SHUFFLE(0, 1, 2, 3)));
+            }
+            std::reverse(data + front, data + back);
+        }
+    }
+
+    namespace avx2 {
+        template<class T, class F>
+        __attribute__((target("avx2"))) void transform(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i]);
+        }
+
+        template<class T, class F>
+        __attribute__((target("avx2"))) void transform_n(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i], i);
+        }
+
+        __attribute__((target("avx2"))) inline float sum(const float *data, std::size_t count)
+        {
+            __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                a0 = _mm256_add_ps(a0, _mm256_loadu_ps(data + i));
+                a1 = _mm256_add_ps(a1, _mm256_loadu_ps(data + i + 8));
+            }
+            const __m256 a = _mm256_add_ps(a0, a1);
+            __m128 t_sum = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            t_sum = _mm_add_ps(t_sum, _mm_movehl_ps(t_sum, t_sum));
+            t_sum = _mm_add_ss(t_sum, _mm_shuffle_ps(t_sum, t_sum, 1));
+            float result = _mm_cvtss_f32(t_sum);
+            for (; i < count; ++i)
+                result += data[i];
+            return result;
+        }
+
+        __attribute__((target("avx2"))) inline std::int32_t sum(const std::int32_t *data, std::size_t count)
+        {
+            __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                a0 = _mm256_add_epi32(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+                a1 = _mm256_add_epi32(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 8)));
+            }
+            const __m256i a = _mm256_add_epi32(a0, a1);
+            __m128i t_sum = _mm_add_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+            t_sum = _mm_add_epi32(t_sum, _mm_shuffle_epi32(t_sum, _MM_SHUFFLE(1, 0, 3, 2)));
+            t_sum = _mm_add_epi32(t_sum, _mm_shuffle_epi32(t_sum, _MM_SHUFFLE(2, 3, 0, 1)));
+            std::uint32_t result = std::uint32_t(_mm_cvtsi128_si32(t_sum));
+            for (; i < count; ++i)
+                result += std::uint32_t(data[i]);
+            return std::int32_t(result);
+        }
+
+        __attribute__((target("avx2"))) inline std::pair<float, float> minmax(const float *data, std::size_t count)
+        {
+            if (count < 8)
+                return scalar::minmax(data, count);
+            __m256 min = _mm256_loadu_ps(data), max = min;
+            std::size_t i = 8;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 value = _mm256_loadu_ps(data + i);
+                min = _mm256_min_ps(min, value);
+                max = _mm256_max_ps(max, value);
+            }
+            alignas(32) float lo[8], hi[8];
+            _mm256_store_ps(lo, min);
+            _mm256_store_ps(hi, max);
+            auto [t_min, t_max] = std::pair{*std::min_element(lo, lo + 8), *std::max_element(hi, hi + 8)};
+            for (; i < count; ++i) {
+                t_min = std::min(t_min, data[i]);
+                t_max = std::max(t_max, data[i]);
+            }
+            return {t_min, t_max};
+        }
+
+        __attribute__((target("avx2"))) inline std::pair<std::int32_t, std::int32_t> minmax(const std::int32_t *data, std::size_t count)
+        {
+            if (count < 8)
+                return scalar::minmax(data, count);
+            __m256i min = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data)), max = min;
+            std::size_t i = 8;
+            for (; i + 8 <= count; i += 8) {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                min = _mm256_min_epi32(min, value);
+                max = _mm256_max_epi32(max, value);
+            }
+            alignas(32) std::int32_t lo[8], hi[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lo), min);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(hi), max);
+            auto [t_min, t_max] = std::pair{*std::min_element(lo, lo + 8), *std::max_element(hi, hi + 8)};
+            for (; i < count; ++i) {
+                t_min = std::min(t_min, data[i]);
+                t_max = std::max(t_max, data[i]);
+            }
+            return {t_min, t_max};
+        }
+
+        template<class T>
+        __attribute__((target("avx2"))) void reverse32(T *data, std::size_t count)
+        {
+            static_assert(sizeof(T) == 4);
+            const __m256i lanes = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+            std::size_t front = 0, back = count;
+            for (; front + 16 <= back; front += 8, back -= 8) {
+                const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + front));
+                const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + back - 8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + front), _mm256_permutevar8x32_epi32(hi, lanes));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + back - 8), _mm256_permutevar8x32_epi32(lo, lanes));
+            }
+            std::reverse(data + front, data + back);
+        }
+    }
+
+    namespace avx512 {
+        template<class T, class F>
+        __attribute__((target("avx512f"))) void transform(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i]);
+        }
+
+        template<class T, class F>
+        __attribute__((target("avx512f"))) void transform_n(T *data, std::size_t count, F &f)
+        {
+            SIMD_KERNELS_IVDEP
+            for (std::size_t i = 0; i < count; ++i)
+                data[i] = f(data[i], i);
+        }
+
+        __attribute__((target("avx512f"))) inline float sum(const float *data, std::size_t count)
+        {
+            __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 32 <= count; i += 32) {
+                a0 = _mm512_add_ps(a0, _mm512_loadu_ps(data + i));
+                a1 = _mm512_add_ps(a1, _mm512_loadu_ps(data + i + 16));
+            }
+            if (i + 16 <= count) {
+                a0 = _mm512_add_ps(a0, _mm512_loadu_ps(data + i));
+                i += 16;
+            }
+            const __mmask16 tail = __mmask16((1u << (count - i)) - 1);
+            a1 = _mm512_add_ps(a1, _mm512_maskz_loadu_ps(tail, data + i));
+            return _mm512_reduce_add_ps(_mm512_add_ps(a0, a1));
+        }
+
+        __attribute__((target("avx512f"))) inline std::int32_t sum(const std::int32_t *data, std::size_t count)
+        {
+            __m512i a0 = _mm512_setzero_si512(), a1 = _mm512_setzero_si512();
+            std::size_t i = 0;
+            for (; i + 32 <= count; i += 32) {
+                a0 = _mm512_add_epi32(a0, _mm512_loadu_si512(data + i));
+                a1 = _mm512_add_epi32(a1, _mm512_loadu_si512(data + i + 16));
+            }
+            if (i + 16 <= count) {
+                a0 = _mm512_add_epi32(a0, _mm512_loadu_si512(data + i));
+                i += 16;
+            }
+            const __mmask16 tail = __mmask16((1u << (count - i)) - 1);
+            a1 = _mm512_add_epi32(a1, _mm512_maskz_loadu_epi32(tail, data + i));
+            return _mm512_reduce_add_epi32(_mm512_add_epi32(a0, a1));
+        }
+
+        __attribute__((target("avx512f"))) inline std::pair<float, float> minmax(const float *data, std::size_t count)
+        {
+            if (count < 16)
+                return scalar::minmax(data, count);
+            __m512 min = _mm512_loadu_ps(data), max = min;
+            std::size_t i = 16;
+            for (; i + 16 <= count; i += 16) {
+                const __m512 value = _mm512_loadu_ps(data + i);
+                min = _mm512_min_ps(min, value);
+                max = _mm512_max_ps(max, value);
+            }
+            // the tail is loaded with the masked lanes keeping the current min/max
+            const __mmask16 tail = __mmask16((1u << (count - i)) - 1);
+            min = _mm512_mask_min_ps(min, tail, min, _mm512_maskz_loadu_ps(tail, data + i));
+            max = _mm512_mask_max_ps(max, tail, max, _mm512_maskz_loadu_ps(tail, data + i));
+            return {_mm512_reduce_min_ps(min), _mm512_reduce_max_ps(max)};
+        }
+
+        __attribute__((target("avx512f"))) inline std::pair<std::int32_t, std::int32_t> minmax(const std::int32_t *data, std::size_t count)
+        {
+            if (count < 16)
+                return scalar::minmax(data, count);
+            __m512i min = _mm512_loadu_si512(data), max = min;
+            std::size_t i = 16;
+            for (; i + 16 <= count; i += 16) {
+                const __m512i value = _mm512_loadu_si512(data + i);
+                min = _mm512_min_epi32(min, value);
+                max = _mm512_max_epi32(max, value);
+            }
+            const __mmask16 tail = __mmask16((1u << (count - i)) - 1);
+            min = _mm512_mask_min_epi32(min, tail, min, _mm512_maskz_loadu_epi32(tail, data + i));
+            max = _mm512_mask_max_epi32(max, tail, max, _mm512_maskz_loadu_epi32(tail, data + i));
+            return {_mm512_reduce_min_epi32(min), _mm512_reduce_max_epi32(max)};
+        }
+
+        template<class T>
+        __attribute__((target("avx512f"))) void reverse32(T *data, std::size_t count)
+        {
+            static_assert(sizeof(T) == 4);
+            const __m512i lanes = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+            std::size_t front = 0, back = count;
+            for (; front + 32 <= back; front += 16, back -= 16) {
+                const __m512i lo = _mm512_loadu_si512(data + front);
+                const __m512i hi = _mm512_loadu_si512(data + back - 16);
+                _mm512_storeu_si512(data + front, _mm512_permutexvar_epi32(lanes, hi));
+                _mm512_storeu_si512(data + back - 16, _mm512_permutexvar_epi32(lanes, lo));
+            }
+            std::reverse(data + front, data + back);
+        }
+    }
+#endif
+
+    // data[i] = f(data[i])
+    template<class T, class F>
+    void transform(T *data, std::size_t count, F &f)
+    {
+        switch (detect()) {
+#if defined(SIMD_KERNELS_X86)
+        case isa::avx512: return avx512::transform(data, count, f);
+        case isa::avx2:   return avx2::transform(data, count, f);
+        case isa::sse2:   return sse2::transform(data, count, f);
+#endif
+        default:          return scalar::transform(data, count, f);
+        }
+    }
+
+    // data[i] = f(data[i], i)
+    template<class T, class F>
+    void transform_n(T *data, std::size_t count, F &f)
+    {
+        switch (detect()) {
+#if defined(SIMD_KERNELS_X86)
+        case isa::avx512: return avx512::transform_n(data, count, f);
+        case isa::avx2:   return avx2::transform_n(data, count, f);
+        case isa::sse2:   return sse2::transform_n(data, count, f);
+#endif
+        default:          return scalar::transform_n(data, count, f);
+        }
+    }
+
+    // float sums are added in lanes, so the rounding differs from a sequential loop
+    template<IsKernelType T>
+    T sum(const T *data, std::size_t count)
+    {
+        switch (detect()) {
+#if defined(SIMD_KERNELS_X86)
+        case isa::avx512: return avx512::sum(data, count);
+        case isa::avx2:   return avx2::sum(data, count);
+        case isa::sse2:   return sse2::sum(data, count);
+#endif
+        default:          return scalar::sum(data, count);
+        }
+    }
+
+    // count must not be zero
+    template<IsKernelType T>
+    std::pair<T, T> minmax(const T *data, std::size_t count)
+    {
+        switch (detect()) {
+#if defined(SIMD_KERNELS_X86)
+        case isa::avx512: return avx512::minmax(data, count);
+        case isa::avx2:   return avx2::minmax(data, count);
+        case isa::sse2:   return sse2::minmax(data, count);
+#endif
+        default:          return scalar::minmax(data, count);
+        }
+    }
+
+    template<class T>
+    void reverse(T *data, std::size_t count)
+    {
+        if constexpr (sizeof(T) == 4 && std::is_arithmetic_v<T>) {
+            switch (detect()) {
+#if defined(SIMD_KERNELS_X86)
+            case isa::avx512: return avx512::reverse32(data, count);
+            case isa::avx2:   return avx2::reverse32(data, count);
+            case isa::sse2:   return sse2::reverse32(data, count);
+#endif
+            default:          break;
+            }
+        }
+        std::reverse(data, data + count);
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing pool for fork-join loops. The thread calling run() takes part
+// in the work, so thread_pool(N) runs on N threads and thread_pool(1) runs
+// everything inline. Tasks must not throw.
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+        : m_queues(threads > 1 ? threads - 1 : 0)
+    {
+        for (auto &queue : m_queues)
+            queue = std::make_unique<task_queue>();
+        for (std::size_t i{0}; i < m_queues.size(); ++i)
+            m_workers.emplace_back([this, i] { work(i); });
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto &worker : m_workers)
+            worker.join();
+    }
+
+    static thread_pool &instance()
+    {
+        static thread_pool inst;
+        return inst;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_workers.size() + 1;
+    }
+
+    // calls f(i) for every i in [0, tasks) and returns when all calls are done
+    template<class F>
+    void run(std::size_t tasks, F &&f)
+    {
+        if (m_workers.empty() || tasks == 1) {
+            for (std::size_t i{0}; i < tasks; ++i)
+                f(i);
+            return;
+        }
+
+        using function_t = std::remove_reference_t<F>;
+        std::atomic<std::size_t> remaining{tasks};
+        const auto call = [](void *context, std::size_t index) {
+            (*static_cast<function_t *>(context))(index);
+        };
+
+        const auto count = m_queues.size();
+        m_pending.fetch_add(tasks);
+        const auto first = m_next.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t q{0}; q < count; ++q) {
+            auto &queue = *m_queues[(first + q) % count];
+            std::lock_guard lock{queue.mutex};
+            for (std::size_t i{q}; i < tasks; i += count)
+                queue.tasks.push_back({call, &f, i, &remaining});
+        }
+        {
+            std::lock_guard lock{m_mutex};
+        }
+        m_wake.notify_all();
+
+        task t_task;
+        while (remaining.load(std::memory_order_acquire) != 0) {
+            if (steal(count, t_task))
+                execute(t_task);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    struct task {
+        void (*call)(void *, std::size_t) {nullptr};
+        void *context {nullptr};
+        std::size_t index {0};
+        std::atomic<std::size_t> *remaining {nullptr};
+    };
+
+    struct task_queue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    void work(std::size_t self)
+    {
+        task t_task;
+        for (;;) {
+            if (pop(self, t_task) || steal(self, t_task)) {
+                execute(t_task);
+                continue;
+            }
+            std::unique_lock lock{m_mutex};
+            m_wake.wait(lock, [this] { return m_stop || m_pending.load() != 0; });
+            if (m_stop && m_pending.load() == 0)
+                return;
+        }
+    }
+
+    // own queue from the back, other queues from the front
+    bool pop(std::size_t self, task &out)
+    {
+        auto &queue = *m_queues[self];
+        std::lock_guard lock{queue.mutex};
+        if (queue.tasks.empty())
+            return false;
+        out = queue.tasks.back();
+        queue.tasks.pop_back();
+        m_pending.fetch_sub(1);
+        return true;
+    }
+
+    bool steal(std::size_t self, task &out)
+    {
+        const auto count = m_queues.size();
+        for (std::size_t i{1}; i <= count; ++i) {
+            auto &queue = *m_queues[(self + i) % count];
+            std::lock_guard lock{queue.mutex};
+            if (queue.tasks.empty())
+                continue;
+            out = queue.tasks.front();
+            queue.tasks.pop_front();
+            m_pending.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    static void execute(const task &t_task)
+    {
+        t_task.call(t_task.context, t_task.index);
+        t_task.remaining->fetch_sub(1, std::memory_order_release);
+    }
+
+    std::vector<std::unique_ptr<task_queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<std::size_t> m_pending{0};
+    std::atomic<std::size_t> m_next{0};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop{false};
+};
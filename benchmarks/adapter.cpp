@@ -0,0 +1,48 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "cases.h"
+#include "adapter/add_algorithms.h"
+
+namespace {
+
+// size - number of elements, op - one element
+
+struct operation {
+    virtual ~operation() = default;
+    virtual void apply(std::uint32_t& value) = 0;
+};
+
+struct scale final : operation {
+    void apply(std::uint32_t& value) override { value = value * 3 + 1; }
+};
+
+}
+
+void adapter_cases(bench::runner& runner) {
+    for (std::size_t size : {1024, 65536, 4194304}) {
+        // unsigned: the same data is scaled on every call, wrapping around is defined
+        add_algorithms<std::vector<std::uint32_t>> values;
+        values.resize(size, 1);
+
+        runner.run("adapter", "for_each", size, size, [&] {
+            values.for_each([](auto& value) { value = value * 3 + 1; });
+        });
+
+        runner.run("adapter", "transform", size, size, [&] {
+            values.transform([](auto value) { return value * 3 + 1; });
+        });
+
+        runner.run("adapter", "lazy", size, size, [&] {
+            values.lazy().for_each([](auto& value) { value = value * 3 + 1; }).run();
+        });
+
+        std::unique_ptr<operation> t_operation = std::make_unique<scale>();
+        auto raw = t_operation.get();
+        bench::do_not_optimize(raw);
+        runner.run("adapter", "virtual", size, size, [&] {
+            for (auto& value : values)
+                raw->apply(value);
+        });
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "harness.h"
+
+// Every group compares a pattern of this repository with the classic
+// implementation through a virtual interface.
+void state_cases(bench::runner& runner);
+void observer_cases(bench::runner& runner);
+void event_cases(bench::runner& runner);
+void chain_cases(bench::runner& runner);
+void strategy_cases(bench::runner& runner);
+void adapter_cases(bench::runner& runner);
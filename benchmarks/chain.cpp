@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "cases.h"
+#include "ChainOfResponsibility/chain_of_responsibility.h"
+
+namespace {
+
+// size - number of handlers, the request is taken by the last one; op - one process()
+
+template <std::size_t I>
+struct length_handler {
+    bool operator()(std::string_view arg) {
+        return arg.size() == I;
+    }
+};
+
+template <std::size_t... I>
+auto make_chain(std::index_sequence<I...>) -> chain_of_responsibility<length_handler<I>...>;
+
+template <std::size_t N>
+using chain_of = decltype(make_chain(std::make_index_sequence<N>{}));
+
+// GoF chain: every handler knows the next one
+struct handler_base {
+    virtual ~handler_base() = default;
+    virtual bool handle(std::string_view arg) = 0;
+
+    bool process(std::string_view arg) {
+        return handle(arg) || (m_next && m_next->process(arg));
+    }
+
+    handler_base* m_next {nullptr};
+};
+
+template <std::size_t I>
+struct virtual_handler final : handler_base {
+    bool handle(std::string_view arg) override {
+        return arg.size() == I;
+    }
+};
+
+template <std::size_t... I>
+std::vector<std::unique_ptr<handler_base>> make_virtual_chain(std::index_sequence<I...>) {
+    std::vector<std::unique_ptr<handler_base>> result;
+    (result.push_back(std::make_unique<virtual_handler<I>>()), ...);
+    for (std::size_t i {1}; i < result.size(); ++i)
+        result[i - 1]->m_next = result[i].get();
+    return result;
+}
+
+constexpr std::uint64_t batch {64};
+
+template <std::size_t N>
+void run(bench::runner& runner) {
+    const std::string request(N - 1, 'x');
+    std::string_view arg {request};
+
+    chain_of<N> chain;
+    runner.run("chain", "chain_of_resp", N, batch, [&] {
+        for (std::uint64_t i {0}; i < batch; ++i) {
+            bench::do_not_optimize(arg);
+            bool taken = chain.process(arg);
+            bench::do_not_optimize(taken);
+        }
+    });
+
+    auto handlers = make_virtual_chain(std::make_index_sequence<N>{});
+    runner.run("chain", "virtual", N, batch, [&] {
+        for (std::uint64_t i {0}; i < batch; ++i) {
+            bench::do_not_optimize(arg);
+            bool taken = handlers.front()->process(arg);
+            bench::do_not_optimize(taken);
+        }
+    });
+}
+
+}
+
+void chain_cases(bench::runner& runner) {
+    run<2>(runner);
+    run<8>(runner);
+    run<32>(runner);
+}
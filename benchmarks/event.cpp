@@ -0,0 +1,71 @@
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "cases.h"
+#include "event/static_event.h"
+
+namespace {
+
+// size - number of handlers, op - one call of one handler
+
+template <std::size_t I>
+struct sensor {
+    void operator()(float celsius) {
+        m_sum += celsius + float(I);
+    }
+
+    float m_sum {0};
+};
+
+struct handler_base {
+    virtual ~handler_base() = default;
+    virtual void operator()(float celsius) = 0;
+};
+
+template <std::size_t I>
+struct virtual_sensor final : handler_base {
+    void operator()(float celsius) override {
+        m_sum += celsius + float(I);
+    }
+
+    float m_sum {0};
+};
+
+constexpr std::uint64_t batch {64};
+
+template <std::size_t... I>
+void run(bench::runner& runner, std::index_sequence<I...>) {
+    constexpr auto size = sizeof...(I);
+
+    auto sensors = std::make_unique<std::tuple<sensor<I>...>>();
+    auto event = std::apply([](auto&... handlers) { return static_event {handlers...}; }, *sensors);
+    runner.run("event", "static_event", size, size * batch, [&] {
+        for (std::uint64_t i {0}; i < batch; ++i) {
+            float celsius = float(i);
+            bench::do_not_optimize(celsius);
+            event(celsius);
+        }
+        bench::do_not_optimize(*sensors);
+    });
+
+    std::vector<std::unique_ptr<handler_base>> handlers;
+    (handlers.push_back(std::make_unique<virtual_sensor<I>>()), ...);
+    runner.run("event", "virtual", size, size * batch, [&] {
+        for (std::uint64_t i {0}; i < batch; ++i) {
+            float celsius = float(i);
+            bench::do_not_optimize(celsius);
+            for (auto& handler : handlers)
+                (*handler)(celsius);
+        }
+    });
+}
+
+}
+
+void event_cases(bench::runner& runner) {
+    run(runner, std::make_index_sequence<2>{});
+    run(runner, std::make_index_sequence<8>{});
+    run(runner, std::make_index_sequence<32>{});
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+    template <class T>
+    inline void do_not_optimize(T& value) {
+        asm volatile("" : "+m"(value) : : "memory");
+    }
+
+    inline void clobber() {
+        asm volatile("" : : : "memory");
+    }
+
+    // Hardware counters of the calling thread, user space only. Any counter the
+    // kernel refuses (no PMU, perf_event_paranoid, containers) reads as -1.
+    class perf_counters {
+    public:
+        enum counter { instructions, cache_misses, count };
+
+        perf_counters() {
+#if defined(__linux__)
+            m_fd[instructions] = open(PERF_COUNT_HW_INSTRUCTIONS);
+            m_fd[cache_misses] = open(PERF_COUNT_HW_CACHE_MISSES);
+#endif
+        }
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        ~perf_counters() {
+#if defined(__linux__)
+            for (auto fd : m_fd) {
+                if (fd >= 0)
+                    close(fd);
+            }
+#endif
+        }
+
+        [[nodiscard]] bool available(counter which) const noexcept {
+            return m_fd[which] >= 0;
+        }
+
+        void start() noexcept {
+#if defined(__linux__)
+            for (auto fd : m_fd) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        void stop() noexcept {
+#if defined(__linux__)
+            for (auto fd : m_fd) {
+                if (fd >= 0)
+                    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+#endif
+        }
+
+        [[nodiscard]] std::int64_t read(counter which) const noexcept {
+#if defined(__linux__)
+            std::uint64_t value {0};
+            if (m_fd[which] >= 0 && ::read(m_fd[which], &value, sizeof(value)) == sizeof(value))
+                return static_cast<std::int64_t>(value);
+#endif
+            return -1;
+        }
+
+    private:
+#if defined(__linux__)
+        static int open(std::uint64_t config) noexcept {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+
+        int m_fd[count] {-1, -1};
+    };
+
+    struct result {
+        std::string group;     // the pattern
+        std::string variant;   // the implementation
+        std::size_t size;      // the parameter of the case, see the group
+        double ns_per_op;
+        double instructions_per_op;   // negative when not available
+        double cache_misses_per_op;   // negative when not available
+        std::uint64_t ops;
+    };
+
+    struct options {
+        double min_time_ms {50};
+        int repeats {5};
+        std::string filter;
+    };
+
+    class runner {
+    public:
+        explicit runner(options opts) : m_options {std::move(opts)} {}
+
+        // body() performs ops_per_call operations; it is repeated until min_time_ms
+        // is reached, the fastest of several repeats is reported
+        template <class F>
+        void run(std::string_view group, std::string_view variant, std::size_t size, std::uint64_t ops_per_call, F&& body) {
+            const auto name = std::string(group) + "/" + std::string(variant) + "/" + std::to_string(size);
+            if (!m_options.filter.empty() && name.find(m_options.filter) == std::string::npos)
+                return;
+
+            const double min_time_ns = m_options.min_time_ms * 1e6;
+            std::uint64_t calls {1};
+            double spent = time(calls, body);
+            while (spent < min_time_ns / 8 && calls < (std::uint64_t {1} << 40)) {
+                calls *= 2;
+                spent = time(calls, body);
+            }
+            calls = std::max<std::uint64_t>(1, std::uint64_t(double(calls) * min_time_ns / std::max(spent, 1.0)));
+
+            double best {1e300};
+            std::int64_t instructions {-1}, misses {-1};
+            for (int r {0}; r < m_options.repeats; ++r) {
+                m_counters.start();
+                const auto spent = time(calls, body);
+                m_counters.stop();
+                if (spent < best) {
+                    best = spent;
+                    instructions = m_counters.read(perf_counters::instructions);
+                    misses = m_counters.read(perf_counters::cache_misses);
+                }
+            }
+
+            const auto ops = calls * ops_per_call;
+            m_results.push_back({std::string(group), std::string(variant), size, best / double(ops),
+                                 instructions < 0 ? -1.0 : double(instructions) / double(ops),
+                                 misses < 0 ? -1.0 : double(misses) / double(ops), ops});
+            print(m_results.back());
+        }
+
+        [[nodiscard]] const std::vector<result>& results() const noexcept {
+            return m_results;
+        }
+
+        void header(std::ostream& out = std::cout) const {
+            out << std::left << std::setw(20) << "group" << std::setw(22) << "variant" << std::right
+                << std::setw(10) << "size" << std::setw(12) << "ns/op" << std::setw(12) << "instr/op"
+                << std::setw(12) << "miss/op" << std::endl;
+        }
+
+        void write_json(std::ostream& out) const {
+            out << "{\n  \"schema\": 1,\n  \"compiler\": \"" << escape(__VERSION__) << "\",\n  \"results\": [\n";
+            for (std::size_t i {0}; i < m_results.size(); ++i) {
+                const auto& t_result = m_results[i];
+                out << "    {\"group\": \"" << escape(t_result.group) << "\", \"variant\": \"" << escape(t_result.variant)
+                    << "\", \"size\": " << t_result.size << ", \"ns_per_op\": " << t_result.ns_per_op
+                    << ", \"instructions_per_op\": " << optional(t_result.instructions_per_op)
+                    << ", \"cache_misses_per_op\": " << optional(t_result.cache_misses_per_op)
+                    << ", \"ops\": " << t_result.ops << "}" << (i + 1 < m_results.size() ? "," : "") << "\n";
+            }
+            out << "  ]\n}\n";
+        }
+
+    private:
+        template <class F>
+        static double time(std::uint64_t calls, F& body) {
+            const auto begin = std::chrono::steady_clock::now();
+            for (std::uint64_t i {0}; i < calls; ++i) {
+                body();
+                clobber();
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        }
+
+        static void print(const result& t_result) {
+            std::cout << std::left << std::setw(20) << t_result.group << std::setw(22) << t_result.variant << std::right
+                      << std::setw(10) << t_result.size << std::setw(12) << std::fixed << std::setprecision(3) << t_result.ns_per_op
+                      << std::setw(12) << counter(t_result.instructions_per_op) << std::setw(12) << counter(t_result.cache_misses_per_op)
+                      << std::defaultfloat << std::endl;
+        }
+
+        static std::string counter(double value) {
+            if (value < 0)
+                return "n/a";
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(3) << value;
+            return out.str();
+        }
+
+        static std::string optional(double value) {
+            return value < 0 ? "null" : std::to_string(value);
+        }
+
+        static std::string escape(std::string_view text) {
+            std::string out;
+            for (auto c : text) {
+                if (c == '"' || c == '\\')
+                    out += '\\';
+                out += c;
+            }
+            return out;
+        }
+
+        options m_options;
+        perf_counters m_counters;
+        std::vector<result> m_results;
+    };
+}
@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include "cases.h"
+
+// benchmarks [--filter <text>] [--json <file>] [--min-time <ms>] [--repeats <n>]
+int main(int argc, char* argv[])
+{
+    bench::options opts;
+    const char* json {nullptr};
+    for (int i {1}; i < argc; ++i) {
+        const std::string_view arg {argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--filter" && has_value)
+            opts.filter = argv[++i];
+        else if (arg == "--json" && has_value)
+            json = argv[++i];
+        else if (arg == "--min-time" && has_value)
+            opts.min_time_ms = std::strtod(argv[++i], nullptr);
+        else if (arg == "--repeats" && has_value)
+            opts.repeats = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::cerr << "usage: " << argv[0] << " [--filter <text>] [--json <file>] [--min-time <ms>] [--repeats <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    bench::runner runner {opts};
+    runner.header();
+    state_cases(runner);
+    observer_cases(runner);
+    event_cases(runner);
+    chain_cases(runner);
+    strategy_cases(runner);
+    adapter_cases(runner);
+
+    if (json) {
+        std::ofstream out {json};
+        runner.write_json(out);
+        if (!out) {
+            std::cerr << "cannot write " << json << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "cases.h"
+#include "observer/subject.h"
+
+namespace {
+
+// size - number of observers, op - one notification delivered to one observer
+
+struct tick { std::uint64_t value; };
+
+template <std::size_t I>
+struct counting_observer {
+    void set(const tick& arg) {
+        m_sum += arg.value + I;
+    }
+
+    std::uint64_t m_sum {0};
+};
+
+template <std::size_t... I>
+auto make_subject(std::index_sequence<I...>) -> subject<counting_observer<I>...>;
+
+template <std::size_t N>
+using subject_of = decltype(make_subject(std::make_index_sequence<N>{}));
+
+struct observer_base {
+    virtual ~observer_base() = default;
+    virtual void set(const tick& arg) = 0;
+};
+
+template <std::size_t I>
+struct virtual_observer final : observer_base {
+    void set(const tick& arg) override {
+        m_sum += arg.value + I;
+    }
+
+    std::uint64_t m_sum {0};
+};
+
+struct virtual_subject {
+    void set(const tick& arg) {
+        for (auto& observer : m_observers)
+            observer->set(arg);
+    }
+
+    std::vector<std::unique_ptr<observer_base>> m_observers;
+};
+
+template <std::size_t... I>
+virtual_subject make_virtual_subject(std::index_sequence<I...>) {
+    virtual_subject result;
+    (result.m_observers.push_back(std::make_unique<virtual_observer<I>>()), ...);
+    return result;
+}
+
+constexpr std::uint64_t batch {64};
+
+template <std::size_t N>
+void run(bench::runner& runner) {
+    auto t_subject = std::make_unique<subject_of<N>>();
+    runner.run("observer", "subject", N, N * batch, [&] {
+        for (std::uint64_t i {0}; i < batch; ++i) {
+            tick arg {i};
+            bench::do_not_optimize(arg);
+            t_subject->set(arg);
+        }
+        bench::do_not_optimize(*t_subject);
+    });
+
+    auto t_virtual = make_virtual_subject(std::make_index_sequence<N>{});
+    runner.run("observer", "virtual", N, N * batch, [&] {
+        for (std::uint64_t i {0}; i < batch; ++i) {
+            tick arg {i};
+            bench::do_not_optimize(arg);
+            t_virtual.set(arg);
+        }
+    });
+}
+
+}
+
+void observer_cases(bench::runner& runner) {
+    run<2>(runner);
+    run<8>(runner);
+    run<32>(runner);
+}
@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <memory>
+#include "cases.h"
+#include "state/meta_fsm.h"
+
+namespace {
+
+// size - number of machines, op - one event processed by one machine
+
+struct flip {};
+
+struct toggle_def {
+    struct off : meta_fsm::state<off> {};
+    struct on : meta_fsm::state<on> {};
+
+    struct count {
+        void operator()(const flip&, auto& fsm) const {
+            ++fsm.m_flips;
+        }
+    };
+
+    using initial_state = off;
+    using transitions   = meta_fsm::transition_table
+    <   /*            State  Event  Next  Action */
+        meta_fsm::tr< off,   flip,  on,   count >,
+        meta_fsm::tr< on,    flip,  off,  count >
+    >;
+
+    std::uint64_t m_flips {0};
+};
+
+using toggle = meta_fsm::state_machine<toggle_def>;
+
+// GoF state: one object per state, the machine points to the current one
+struct toggle_state {
+    virtual ~toggle_state() = default;
+    virtual toggle_state* on_flip(std::uint64_t& flips) = 0;
+};
+
+struct virtual_off final : toggle_state {
+    toggle_state* on_flip(std::uint64_t& flips) override;
+};
+
+struct virtual_on final : toggle_state {
+    toggle_state* on_flip(std::uint64_t& flips) override;
+};
+
+virtual_off s_off;
+virtual_on s_on;
+
+toggle_state* virtual_off::on_flip(std::uint64_t& flips) {
+    ++flips;
+    return &s_on;
+}
+
+toggle_state* virtual_on::on_flip(std::uint64_t& flips) {
+    ++flips;
+    return &s_off;
+}
+
+struct virtual_toggle {
+    void process_event(flip) {
+        m_current = m_current->on_flip(m_flips);
+    }
+
+    toggle_state* m_current {&s_off};
+    std::uint64_t m_flips {0};
+};
+
+}
+
+void state_cases(bench::runner& runner) {
+    for (std::size_t size : {1, 1024, 65536}) {
+        auto machines = std::make_unique<toggle[]>(size);
+        runner.run("state", "meta_fsm", size, size, [&] {
+            for (std::size_t i {0}; i < size; ++i)
+                machines[i].process_event(flip {});
+        });
+
+        auto virtual_machines = std::make_unique<virtual_toggle[]>(size);
+        runner.run("state", "virtual", size, size, [&] {
+            for (std::size_t i {0}; i < size; ++i)
+                virtual_machines[i].process_event(flip {});
+        });
+    }
+}
@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "cases.h"
+#include "strategy/context.h"
+
+namespace {
+
+// size - number of contexts with mixed strategies, op - one update() of one context
+
+struct blink_slow {
+    void timeout(int ms) { m_elapsed += std::uint32_t(ms); }
+    std::uint32_t m_elapsed {0};
+};
+
+struct blink_fast {
+    void timeout(int ms) { m_elapsed += std::uint32_t(ms) * 2; }
+    std::uint32_t m_elapsed {0};
+};
+
+struct blink_off {
+    void timeout(int) { ++m_ticks; }
+    std::uint32_t m_ticks {0};
+};
+
+struct blink_base {
+    virtual ~blink_base() = default;
+    virtual void timeout(int ms) = 0;
+};
+
+struct virtual_slow final : blink_base {
+    void timeout(int ms) override { m_elapsed += std::uint32_t(ms); }
+    std::uint32_t m_elapsed {0};
+};
+
+struct virtual_fast final : blink_base {
+    void timeout(int ms) override { m_elapsed += std::uint32_t(ms) * 2; }
+    std::uint32_t m_elapsed {0};
+};
+
+struct virtual_off final : blink_base {
+    void timeout(int) override { ++m_ticks; }
+    std::uint32_t m_ticks {0};
+};
+
+template <class Context>
+std::vector<Context> make_contexts(std::size_t size) {
+    std::vector<Context> contexts(size);
+    for (std::size_t i {0}; i < size; ++i) {
+        if (i % 3 == 1)
+            contexts[i].setStrategy(blink_fast {});
+        else if (i % 3 == 2)
+            contexts[i].setStrategy(blink_off {});
+    }
+    return contexts;
+}
+
+}
+
+void strategy_cases(bench::runner& runner) {
+    for (std::size_t size : {1024, 65536, 1048576}) {
+        auto contexts = make_contexts<context<blink_slow, blink_fast, blink_off>>(size);
+        runner.run("strategy", "context", size, size, [&] {
+            for (auto& t_context : contexts)
+                t_context.update(5);
+        });
+        contexts = {};
+
+        auto tables = make_contexts<table_context<blink_slow, blink_fast, blink_off>>(size);
+        runner.run("strategy", "table_context", size, size, [&] {
+            for (auto& t_context : tables)
+                t_context.update(5);
+        });
+        tables = {};
+
+        context_pool<blink_slow, blink_fast, blink_off> pool;
+        pool.reserve(size);
+        for (std::size_t i {0}; i < size; ++i) {
+            const auto id = pool.add();
+            if (i % 3 == 1)
+                pool.setStrategy(id, blink_fast {});
+            else if (i % 3 == 2)
+                pool.setStrategy(id, blink_off {});
+        }
+        runner.run("strategy", "context_pool", size, size, [&] {
+            pool.update(5);
+        });
+
+        std::vector<std::unique_ptr<blink_base>> strategies;
+        strategies.reserve(size);
+        for (std::size_t i {0}; i < size; ++i) {
+            if (i % 3 == 0)
+                strategies.push_back(std::make_unique<virtual_slow>());
+            else if (i % 3 == 1)
+                strategies.push_back(std::make_unique<virtual_fast>());
+            else
+                strategies.push_back(std::make_unique<virtual_off>());
+        }
+        runner.run("strategy", "virtual", size, size, [&] {
+            for (auto& strategy : strategies)
+                strategy->timeout(5);
+        });
+    }
+}
@@ -1,19 +1,6 @@
+#include <fstream>
 #include <iostream>
-#include <tuple>
-
-template<class... Args>
-struct static_event {
-    constexpr static_event(Args&... args) : m_objects{args...}
-    {}
-
-    template<class... Vars>
-    void operator()(Vars... vars) {
-        std::apply([&](auto&... tuples){ (tuples(vars...), ...); }, m_objects);
-    }
-
-private:
-    std::tuple<Args&...> m_objects;
-};
+#include "static_event.h"
 
 struct display_t {
     void operator()(float celsius) {
@@ -45,5 +32,11 @@ int main()
     event(33.5f);
     event(35.5f);
 
+#if defined(PATTERNS_INSTRUMENTATION)
+    instrument::report(std::cout);
+    std::ofstream trace {"event_trace.json"};
+    instrument::trace().write_chrome_json(trace);
+#endif
+
     return 0;
 }
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include "../instrument/instrument.h"
+
+template<class... Args>
+struct static_event {
+    constexpr static_event(Args&... args) : m_objects{args...}
+    {}
+
+    template<class... Vars>
+    void operator()(Vars... vars) {
+        std::apply([&](auto&... tuples){
+            std::size_t index {0};
+            (instrument::policy::measure<static_event, Args...>(index++, [&]{ tuples(vars...); }), ...);
+        }, m_objects);
+    }
+
+private:
+    std::tuple<Args&...> m_objects;
+};
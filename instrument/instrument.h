@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Opt-in instrumentation of the patterns. subject::set, static_event::operator(),
+// chain_of_responsibility::process and context::update call their members
+// through instrument::policy::measure(). By default that is null_policy, which
+// only calls the member. With PATTERNS_INSTRUMENTATION defined for the whole
+// program (cmake -DPATTERNS_INSTRUMENTATION=ON) it is counting_policy: every
+// call is counted and timed per thread and written to a trace ring buffer.
+namespace instrument {
+
+    // cheap monotonic tick counter, the unit is only compared with itself
+    inline std::uint64_t cycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    inline std::uint64_t now_ns() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    template <class T>
+    constexpr std::string_view type_name() noexcept {
+        constexpr std::string_view name = __PRETTY_FUNCTION__;
+        constexpr std::string_view key = "T = ";
+        constexpr auto first = name.find(key) + key.size();
+        constexpr auto last = name.find_first_of(";]", first);
+        return name.substr(first, last - first);
+    }
+
+    inline std::uint32_t thread_index() noexcept {
+        static std::atomic<std::uint32_t> s_next {0};
+        thread_local const std::uint32_t t_index = s_next.fetch_add(1, std::memory_order_relaxed);
+        return t_index;
+    }
+
+    struct member_stats {
+        std::string_view name;
+        std::uint64_t calls;
+        std::uint64_t cycles;
+    };
+
+    // every instrumented template instantiation registers its printer here
+    class registry {
+    public:
+        using report_t = void (*)(std::ostream&);
+
+        static registry& instance() {
+            static registry inst;
+            return inst;
+        }
+
+        void add(report_t report) {
+            std::lock_guard lock {m_mutex};
+            m_reports.push_back(report);
+        }
+
+        void report(std::ostream& out) {
+            std::lock_guard lock {m_mutex};
+            for (auto t_report : m_reports)
+                t_report(out);
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<report_t> m_reports;
+    };
+
+    // Per-thread call counters of the members of one site. Each member has its
+    // own cache line in a block owned by the thread, so counting never shares
+    // a line between threads. Blocks outlive their threads.
+    template <class Site, class... Members>
+    class counters {
+    public:
+        static constexpr std::size_t count = sizeof...(Members);
+
+        struct alignas(64) slot {
+            std::atomic<std::uint64_t> calls {0};
+            std::atomic<std::uint64_t> cycles {0};
+        };
+
+        static void add(std::size_t index, std::uint64_t spent) noexcept {
+            thread_local block* t_block = attach();
+            auto& t_slot = t_block->slots[index];
+            t_slot.calls.store(t_slot.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            t_slot.cycles.store(t_slot.cycles.load(std::memory_order_relaxed) + spent, std::memory_order_relaxed);
+        }
+
+        static std::array<member_stats, count> snapshot() {
+            std::array<member_stats, count> result {};
+            for (std::size_t i {0}; i < count; ++i)
+                result[i] = {s_names[i], 0, 0};
+
+            std::lock_guard lock {s_mutex};
+            for (const auto& t_block : s_blocks) {
+                for (std::size_t i {0}; i < count; ++i) {
+                    result[i].calls += t_block->slots[i].calls.load(std::memory_order_relaxed);
+                    result[i].cycles += t_block->slots[i].cycles.load(std::memory_order_relaxed);
+                }
+            }
+            return result;
+        }
+
+        static void report(std::ostream& out) {
+            out << type_name<Site>() << std::endl;
+            for (const auto& t_stats : snapshot())
+                out << "    " << t_stats.name << ": calls " << t_stats.calls << ", cycles " << t_stats.cycles << std::endl;
+        }
+
+        static constexpr std::array<std::string_view, count> s_names {type_name<Members>()...};
+
+    private:
+        struct block {
+            std::array<slot, count> slots;
+        };
+
+        static block* attach() {
+            // registered without s_mutex held, report() takes the locks in the other order
+            static const bool s_registered = (registry::instance().add(&report), true);
+            (void)s_registered;
+
+            std::lock_guard lock {s_mutex};
+            s_blocks.push_back(std::make_unique<block>());
+            return s_blocks.back().get();
+        }
+
+        static inline std::mutex s_mutex;
+        static inline std::vector<std::unique_ptr<block>> s_blocks;
+    };
+
+    // Fixed-size multi-producer ring of complete ("X") trace events. Writers
+    // never wait: the oldest events are overwritten. Every slot is a seqlock
+    // which a writer claims with a CAS; if another writer holds the slot or it
+    // already has a newer event, the event is dropped. A dump skips events
+    // which are rewritten while it reads them.
+    template <std::size_t Capacity>
+    class trace_ring {
+        static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        void push(const std::string_view* name, std::uint64_t begin_ns, std::uint64_t duration_ns) noexcept {
+            const auto position = m_head.fetch_add(1, std::memory_order_relaxed);
+            auto& t_event = m_events[position & (Capacity - 1)];
+            const auto complete = 2 * (position + 1);
+            auto sequence = t_event.sequence.load(std::memory_order_relaxed);
+            if (sequence % 2 != 0 || sequence >= complete
+                || !t_event.sequence.compare_exchange_strong(sequence, complete - 1, std::memory_order_relaxed))
+                return;
+            std::atomic_thread_fence(std::memory_order_release);
+            t_event.name.store(name, std::memory_order_relaxed);
+            t_event.begin.store(begin_ns, std::memory_order_relaxed);
+            t_event.duration.store(duration_ns, std::memory_order_relaxed);
+            t_event.thread.store(thread_index(), std::memory_order_relaxed);
+            t_event.sequence.store(complete, std::memory_order_release);
+        }
+
+        // chrome://tracing and Perfetto format
+        void write_chrome_json(std::ostream& out) const {
+            out << "{\"traceEvents\":[";
+            bool first {true};
+            for (const auto& t_event : m_events) {
+                const auto sequence = t_event.sequence.load(std::memory_order_acquire);
+                const auto name = t_event.name.load(std::memory_order_relaxed);
+                const auto begin = t_event.begin.load(std::memory_order_relaxed);
+                const auto duration = t_event.duration.load(std::memory_order_relaxed);
+                const auto thread = t_event.thread.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence == 0 || sequence % 2 != 0 || sequence != t_event.sequence.load(std::memory_order_relaxed) || name == nullptr)
+                    continue;
+
+                out << (first ? "\n" : ",\n") << "{\"name\":\"";
+                for (auto c : *name) {
+                    if (c == '"' || c == '\\')
+                        out << '\\';
+                    out << c;
+                }
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                    << ",\"ts\":" << begin / 1000 << '.' << begin % 1000 / 100 << begin % 100 / 10 << begin % 10
+                    << ",\"dur\":" << duration / 1000 << '.' << duration % 1000 / 100 << duration % 100 / 10 << duration % 10
+                    << "}";
+                first = false;
+            }
+            out << "\n]}\n";
+        }
+
+    private:
+        struct event {
+            std::atomic<std::uint64_t> sequence {0};   // 2 * (position + 1) when complete, odd while written
+            std::atomic<const std::string_view*> name {nullptr};
+            std::atomic<std::uint64_t> begin {0};
+            std::atomic<std::uint64_t> duration {0};
+            std::atomic<std::uint32_t> thread {0};
+        };
+
+        alignas(64) std::atomic<std::uint64_t> m_head {0};
+        std::array<event, Capacity> m_events {};
+    };
+
+    inline constexpr std::size_t trace_capacity {1 << 16};
+
+    inline trace_ring<trace_capacity>& trace() {
+        static auto inst = std::make_unique<trace_ring<trace_capacity>>();
+        return *inst;
+    }
+
+    inline void report(std::ostream& out) {
+        registry::instance().report(out);
+    }
+
+    template <class Site, class... Members>
+    std::array<member_stats, sizeof...(Members)> stats() {
+        return counters<Site, Members...>::snapshot();
+    }
+
+    struct null_policy {
+        template <class Site, class... Members, class F>
+        static decltype(auto) measure(std::size_t, F&& f) {
+            return std::forward<F>(f)();
+        }
+    };
+
+    struct counting_policy {
+        // index - position of the called member in Members
+        template <class Site, class... Members, class F>
+        static decltype(auto) measure(std::size_t index, F&& f) {
+            struct scope {
+                ~scope() {
+                    counters<Site, Members...>::add(index, cycles() - begin_cycles);
+                    trace().push(&counters<Site, Members...>::s_names[index], begin_ns, now_ns() - begin_ns);
+                }
+
+                std::size_t index;
+                std::uint64_t begin_ns {now_ns()};
+                std::uint64_t begin_cycles {cycles()};
+            } t_scope {index};
+            return std::forward<F>(f)();
+        }
+    };
+
+#if defined(PATTERNS_INSTRUMENTATION)
+    using policy = counting_policy;
+#else
+    using policy = null_policy;
+#endif
+}
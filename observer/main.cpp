@@ -1,51 +1,16 @@
 #include <iostream>
-#include <tuple>
+#include "subject.h"
 
 namespace event {
     struct open { bool state; };
     struct start{ bool state; };
 }
 
-template <class OBSERVER, class ARG>
-concept IsCall = requires(OBSERVER observer, ARG&& arg) {
-    observer.set(std::forward<ARG>(arg));
-};
-
-struct call_helper {
-    template <class OBSERVER, class ARG> requires IsCall<OBSERVER, ARG>
-    void operator()(OBSERVER& observer, ARG&& args) {
-        observer.set(std::forward<ARG>(args));
-    }
-
-    template <class OBSERVER, class ARG>
-    void operator()(OBSERVER&, ARG&&) {}
-};
-
 struct proxy {
     template <class E>
     void set(E&& arg);
 };
 
-template <class... OBSERVERs>
-struct subject {
-
-    static subject& instance() {
-        static subject inst;
-        return inst;
-    }
-
-    template <class E>
-    void set(E&& arg) {
-        std::apply([&](auto&... observers) {
-            (call_helper {}(observers, std::forward<E>(arg)), ...);
-        },
-        m_observers);
-    }
-
-private:
-    std::tuple<OBSERVERs...> m_observers;
-};
-
 struct observer_net {
     void set(event::open&& arg) {
         if (arg.state) {
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "../instrument/instrument.h"
+
+template <class OBSERVER, class ARG>
+concept IsCall = requires(OBSERVER observer, ARG&& arg) {
+    observer.set(std::forward<ARG>(arg));
+};
+
+struct call_helper {
+    template <class OBSERVER, class ARG> requires IsCall<OBSERVER, ARG>
+    void operator()(OBSERVER& observer, ARG&& args) {
+        observer.set(std::forward<ARG>(args));
+    }
+
+    template <class OBSERVER, class ARG>
+    void operator()(OBSERVER&, ARG&&) {}
+};
+
+template <class... OBSERVERs>
+struct subject {
+
+    static subject& instance() {
+        static subject inst;
+        return inst;
+    }
+
+    template <class E>
+    void set(E&& arg) {
+        std::apply([&](auto&... observers) {
+            std::size_t index {0};
+            auto t_call = [&](auto& observer) {
+                // observers which ignore E are not counted as calls
+                if constexpr (IsCall<std::decay_t<decltype(observer)>, E>) {
+                    instrument::policy::measure<subject, OBSERVERs...>(index, [&] {
+                        call_helper {}(observer, std::forward<E>(arg));
+                    });
+                }
+                else {
+                    call_helper {}(observer, std::forward<E>(arg));
+                }
+                ++index;
+            };
+            (t_call(observers), ...);
+        },
+        m_observers);
+    }
+
+private:
+    std::tuple<OBSERVERs...> m_observers;
+};
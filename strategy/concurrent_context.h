@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "context.h"
+
+// Context whose strategy can be replaced from a control thread while worker
+// threads keep calling update() without locks.
+//
+// Readers register in one of two epoch counters; a writer publishes the new
+// strategy, flips the epoch and waits until the readers of the previous epoch
+// are gone before the old strategy is destroyed. Writers are serialized by a
+// mutex, readers never touch it. Only the swap is synchronized: with several
+// workers the strategy's timeout() itself has to tolerate concurrent calls.
+//
+// If the new strategy has on_handover(const Old&), it is called after the grace
+// period, when no update() is running on the old strategy any more, so the hook
+// may read all of its state. The new strategy is already published at that
+// moment: what the hook writes into it is subject to the same rules as
+// concurrent timeout() calls, e.g. accumulate into atomics instead of
+// overwriting.
+template <class... Ts>
+struct concurrent_context {
+
+    concurrent_context() : m_current { new node { std::in_place_type<init_type> } } {}
+
+    concurrent_context(const concurrent_context&) = delete;
+    concurrent_context& operator=(const concurrent_context&) = delete;
+
+    ~concurrent_context() {
+        delete m_current.load();
+    }
+
+    template <class U>
+    void setStrategy(U&& strategy) {
+        emplace_strategy<std::decay_t<U>>(std::forward<U>(strategy));
+    }
+
+    template <class U, class... Args>
+    void emplace_strategy(Args&&... args) {
+        static_assert(meta::find<U, Ts...>() < sizeof...(Ts), "unknown strategy type");
+
+        std::lock_guard lock { m_writer };
+        auto next = new node { std::in_place_type<U>, std::forward<Args>(args)... };
+        const std::unique_ptr<node> prev { m_current.exchange(next) };
+        const auto epoch = m_epoch.fetch_add(1);
+        while (m_readers[epoch & 1].load() != 0)
+            std::this_thread::yield();
+
+        std::visit([&](const auto& old) {
+            call_on_handover {}(*std::get_if<U>(&next->strategy), old);
+        },
+        prev->strategy);
+    }
+
+    void update(int ms) {
+        const reader_guard guard { *this };
+        std::visit([&](auto&& strategy) {
+            strategy.timeout(ms);
+        },
+        m_current.load()->strategy);
+    }
+
+    [[nodiscard]] std::size_t index() const noexcept {
+        const reader_guard guard { *this };
+        return m_current.load()->strategy.index();
+    }
+
+private:
+    using init_type = typename meta::get_type_from_index<0, Ts...>;
+
+    struct node {
+        template <class... Args>
+        explicit node(Args&&... args) : strategy { std::forward<Args>(args)... } {}
+
+        std::variant<Ts...> strategy;
+    };
+
+    // leaves the epoch also when timeout() throws, a writer would wait forever otherwise
+    class reader_guard {
+    public:
+        explicit reader_guard(const concurrent_context& context) noexcept
+            : m_readers { context.m_readers[context.enter() & 1] } {}
+
+        reader_guard(const reader_guard&) = delete;
+        reader_guard& operator=(const reader_guard&) = delete;
+
+        ~reader_guard() {
+            m_readers.fetch_sub(1, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<std::size_t>& m_readers;
+    };
+
+    // the counter is taken for the epoch which is still current after the increment,
+    // otherwise a writer could already be past the wait for it
+    std::size_t enter() const noexcept {
+        for (;;) {
+            const auto epoch = m_epoch.load();
+            m_readers[epoch & 1].fetch_add(1);
+            if (m_epoch.load() == epoch)
+                return epoch;
+            m_readers[epoch & 1].fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    std::atomic<node*> m_current;
+    std::atomic<std::size_t> m_epoch {0};
+    alignas(64) mutable std::atomic<std::size_t> m_readers[2] {};
+    std::mutex m_writer;
+};
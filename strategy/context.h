@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "../instrument/instrument.h"
+
+namespace meta {
+    template <size_t N, typename T, typename... Ts>
+    struct get_type_by_index {
+        using type = typename get_type_by_index<N - 1, Ts...>::type;
+    };
+
+    template <typename T, typename... Ts>
+    struct get_type_by_index<0, T, Ts...> {
+        using type = T;
+    };
+
+    template <size_t N, typename... Ts>
+    using get_type_from_index = typename get_type_by_index<N, Ts...>::type;
+
+    template <typename T, typename... Ts>
+    constexpr std::size_t find() noexcept {
+        constexpr bool is_true[] = {std::is_same_v<T, Ts>...};
+        for (std::size_t i {0}; i < sizeof...(Ts); ++i) {
+            if (is_true[i])
+                return i;
+        }
+        return sizeof...(Ts);
+    }
+}
+
+// optional New::on_handover(const Old&) - carries state over when the strategy is replaced
+template <class New, class Old>
+concept CallOnHandover = requires(New strategy, const Old& old) {
+    strategy.on_handover(old);
+};
+
+struct call_on_handover {
+    template <class New, class Old> requires CallOnHandover<New, Old>
+    void operator()(New& strategy, const Old& old) const { strategy.on_handover(old); }
+
+    template <class New, class Old>
+    void operator()(New&, const Old&) const {}
+};
+
+// Dispatch policies of the context
+struct visit_dispatch {};   // std::visit over the variant
+struct table_dispatch {};   // compile-time table of function pointers indexed by variant::index()
+
+template <class Dispatch, class... Ts>
+struct basic_context {
+
+    template <class U>
+    void setStrategy(U&& strategy) {
+        m_strategy = std::forward<U>(strategy);
+    }
+
+    template <class U, class... Args>
+    U& emplace_strategy(Args&&... args) {
+        return m_strategy.template emplace<U>(std::forward<Args>(args)...);
+    }
+
+    void update(int ms) {
+        // a throwing strategy constructor leaves no strategy, index() is variant_npos then
+        if (m_strategy.valueless_by_exception())
+            throw std::bad_variant_access {};
+
+        instrument::policy::measure<basic_context, Ts...>(m_strategy.index(), [&] {
+            if constexpr (std::is_same_v<Dispatch, table_dispatch>) {
+                s_table[m_strategy.index()](m_strategy, ms);
+            }
+            else {
+                std::visit([&](auto&& strategy) {
+                    strategy.timeout(ms);
+                },
+                m_strategy);
+            }
+        });
+    }
+
+private:
+    using init_type = typename meta::get_type_from_index<0, Ts...>;
+    using variant_t = std::variant<Ts...>;
+    using timeout_t = void (*)(variant_t&, int);
+
+    template <class T>
+    static void call_timeout(variant_t& strategy, int ms) {
+        std::get_if<T>(&strategy)->timeout(ms);
+    }
+
+    static constexpr std::array<timeout_t, sizeof...(Ts)> s_table { &call_timeout<Ts>... };
+
+    variant_t m_strategy { init_type {} };
+};
+
+template <class... Ts>
+using context = basic_context<visit_dispatch, Ts...>;
+
+template <class... Ts>
+using table_context = basic_context<table_dispatch, Ts...>;
+
+// Many contexts with the same set of strategies. Every strategy type keeps its
+// own dense array, so update() runs one homogeneous loop per strategy instead
+// of dispatching each element separately.
+template <class... Ts>
+struct context_pool {
+    using id_t = std::size_t;
+
+    id_t add() {
+        const id_t id = m_index.size();
+        m_index.push_back(0);
+        m_slot.push_back(bucket<0>().items.size());
+        bucket<0>().items.emplace_back();
+        bucket<0>().owners.push_back(id);
+        return id;
+    }
+
+    template <class U>
+    void setStrategy(id_t id, U&& strategy) {
+        using strategy_t = std::decay_t<U>;
+        constexpr auto index = meta::find<strategy_t, Ts...>();
+        static_assert(index < sizeof...(Ts), "unknown strategy type");
+
+        // built first: strategy may refer to an element which remove() moves or destroys
+        strategy_t value(std::forward<U>(strategy));
+        remove(id);
+        auto& target = bucket<index>();
+        m_index[id] = index;
+        m_slot[id] = target.items.size();
+        target.items.push_back(std::move(value));
+        target.owners.push_back(id);
+    }
+
+    [[nodiscard]] std::size_t index(id_t id) const noexcept {
+        return m_index[id];
+    }
+
+    // nullptr if U is not the active strategy of the context, like std::get_if
+    template <class U>
+    [[nodiscard]] U* get_if(id_t id) noexcept {
+        constexpr auto index = meta::find<U, Ts...>();
+        static_assert(index < sizeof...(Ts), "unknown strategy type");
+        if (m_index[id] != index)
+            return nullptr;
+        return &bucket<index>().items[m_slot[id]];
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return m_index.size();
+    }
+
+    void reserve(std::size_t count) {
+        m_index.reserve(count);
+        m_slot.reserve(count);
+        bucket<0>().items.reserve(count);
+        bucket<0>().owners.reserve(count);
+    }
+
+    void update(int ms) {
+        std::apply([&](auto&... buckets) {
+            (update(buckets.items, ms), ...);
+        },
+        m_buckets);
+    }
+
+private:
+    template <class T>
+    struct storage {
+        std::vector<T> items;
+        std::vector<id_t> owners;
+    };
+
+    template <std::size_t I>
+    auto& bucket() noexcept {
+        return std::get<I>(m_buckets);
+    }
+
+    template <class T>
+    static void update(std::vector<T>& items, int ms) {
+        for (auto& item : items)
+            item.timeout(ms);
+    }
+
+    // swap-and-pop the context out of the bucket of its active strategy
+    void remove(id_t id) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((m_index[id] == I ? remove(bucket<I>(), m_slot[id]) : void()), ...);
+        }(std::index_sequence_for<Ts...>{});
+    }
+
+    template <class T>
+    void remove(storage<T>& from, std::size_t slot) {
+        const auto last = from.items.size() - 1;
+        if (slot != last) {
+            from.items[slot] = std::move(from.items[last]);
+            from.owners[slot] = from.owners[last];
+            m_slot[from.owners[slot]] = slot;
+        }
+        from.items.pop_back();
+        from.owners.pop_back();
+    }
+
+    std::vector<std::size_t> m_index;   // active strategy of every context
+    std::vector<std::size_t> m_slot;    // position of the context inside its bucket
+    std::tuple<storage<Ts>...> m_buckets;
+};
@@ -1,20 +1,14 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <iostream>
-#include <variant>
-
-namespace meta {
-    template <size_t N, typename T, typename... Ts>
-    struct get_type_by_index {
-        using type = typename get_type_by_index<N - 1, Ts...>::type;
-    };
-
-    template <typename T, typename... Ts>
-    struct get_type_by_index<0, T, Ts...> {
-        using type = T;
-    };
-
-    template <size_t N, typename... Ts>
-    using get_type_from_index = typename get_type_by_index<N, Ts...>::type;
-}
+#include <memory>
+#include <thread>
+#include <vector>
+#include "context.h"
+#include "concurrent_context.h"
+#include "tuned_context.h"
 
 struct blue_blink {
     void timeout(int ms) {
@@ -26,6 +20,10 @@ struct green_blink {
     void timeout(int ms) {
         std::cout << __PRETTY_FUNCTION__ << " " << ms << std::endl;
     }
+
+    void on_handover(const blue_blink&) {
+        std::cout << __PRETTY_FUNCTION__ << std::endl;
+    }
 };
 
 struct red_blink {
@@ -34,27 +32,101 @@ struct red_blink {
     }
 };
 
-template <class... Ts>
-struct context {
+struct fade_columns;
+
+// the same fade of a led matrix, the traversal order differs
+struct fade_rows {
+    void timeout(int ms) {
+        for (std::size_t row {0}; row < side; ++row)
+            for (std::size_t col {0}; col < side; ++col)
+                leds[row * side + col] = (leds[row * side + col] + ms) & 0xff;
+    }
+
+    void on_handover(const fade_columns& other);
+
+    static constexpr std::size_t side {1024};
+    std::array<int, side * side> leds {};
+};
+
+struct fade_columns {
+    void timeout(int ms) {
+        for (std::size_t col {0}; col < side; ++col)
+            for (std::size_t row {0}; row < side; ++row)
+                leds[row * side + col] = (leds[row * side + col] + ms) & 0xff;
+    }
+
+    void on_handover(const fade_rows& other) {
+        leds = other.leds;
+    }
+
+    static constexpr std::size_t side {1024};
+    std::array<int, side * side> leds {};
+};
+
+void fade_rows::on_handover(const fade_columns& other) {
+    leds = other.leds;
+}
+
+// stateless, the cost stays the same: the tuner has to converge once and stay
+struct spin_short {
+    void timeout(int ms) {
+        std::atomic<int> spin {0};
+        for (int i {0}; i < ms; ++i)
+            spin.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+struct spin_long {
+    void timeout(int ms) {
+        std::atomic<int> spin {0};
+        for (int i {0}; i < 2 * ms; ++i)
+            spin.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// stress of concurrent_context: every update() adds one, the hand-over carries
+// the sum, so nothing may be lost or counted on a destroyed strategy
+template <int I>
+struct tally {
+    static constexpr int alive {0x5a5a5a5a};
+
+    ~tally() { m_guard = 0; }
+
+    void timeout(int) {
+        if (m_guard != alive)
+            ++s_dead_calls;
+        m_total.fetch_add(1, std::memory_order_relaxed);
+    }
 
-    template <class U>
-    void setStrategy(U&& strategy) {
-        m_strategy = std::move(strategy);
+    template <int J>
+    void on_handover(const tally<J>& old) {
+        m_total.fetch_add(old.m_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
 
-    void update(int ms) {
-        std::visit([&](auto&& strategy) {
-            strategy.timeout(ms);
-        },
-        m_strategy);
+    int m_guard {alive};
+    std::atomic<long> m_total {0};
+    static inline std::atomic<long> s_dead_calls {0};
+};
+
+// takes the final sum out of the stress context
+struct tally_result {
+    void timeout(int) {}
+
+    template <int J>
+    void on_handover(const tally<J>& old) {
+        s_total = old.m_total.load();
     }
 
-private:
-    using init_type = typename meta::get_type_from_index<0, Ts...>;
-    std::variant<Ts...> m_strategy { init_type {} };
+    static inline long s_total {0};
 };
 
 using context_t = context<blue_blink, green_blink, red_blink>;
+using table_context_t = table_context<blue_blink, green_blink, red_blink>;
+using context_pool_t = context_pool<blue_blink, green_blink, red_blink>;
+using concurrent_context_t = concurrent_context<blue_blink, green_blink, red_blink>;
+using stress_context_t = concurrent_context<tally<0>, tally<1>, tally_result>;
+using tuned_context_t = tuned_context<fade_columns, fade_rows>;
+using steady_context_t = tuned_context<spin_long, spin_short>;
 
 int main(int argc, char* argv[])
 {
@@ -65,5 +137,81 @@ int main(int argc, char* argv[])
     m_ctx.setStrategy(red_blink {});
     m_ctx.update(5);
 
+    table_context_t t_ctx;
+    t_ctx.update(10);
+    t_ctx.setStrategy(red_blink {});
+    t_ctx.update(10);
+
+    context_pool_t pool;
+    auto first = pool.add();
+    auto second = pool.add();
+    pool.add();
+    pool.setStrategy(first, red_blink {});
+    pool.setStrategy(second, green_blink {});
+    pool.update(15); // blue, green, red - one loop per strategy
+    if (auto t_red = pool.get_if<red_blink>(first); t_red && !pool.get_if<green_blink>(first))
+        t_red->timeout(15);
+
+    using namespace std::chrono_literals;
+    concurrent_context_t c_ctx;
+    std::atomic<bool> running {true};
+    std::thread worker([&] {
+        while (running) {
+            c_ctx.update(20); // never blocked by the swaps below
+            std::this_thread::sleep_for(20ms);
+        }
+    });
+    std::this_thread::sleep_for(50ms);
+    c_ctx.emplace_strategy<green_blink>(); // calls green_blink::on_handover(const blue_blink&)
+    std::this_thread::sleep_for(50ms);
+    c_ctx.setStrategy(red_blink {});
+    std::this_thread::sleep_for(50ms);
+    running = false;
+    worker.join();
+
+    constexpr int workers {4};
+    constexpr long updates {200000};
+    stress_context_t s_ctx;
+    std::atomic<int> done {0};
+    std::vector<std::thread> threads;
+    for (int i {0}; i < workers; ++i) {
+        threads.emplace_back([&] {
+            for (long j {0}; j < updates; ++j)
+                s_ctx.update(1);
+            ++done;
+        });
+    }
+    long swaps {0};
+    for (; done != workers; ++swaps) {
+        if (swaps % 2)
+            s_ctx.emplace_strategy<tally<0>>();
+        else
+            s_ctx.emplace_strategy<tally<1>>();
+    }
+    for (auto& t_thread : threads)
+        t_thread.join();
+    s_ctx.emplace_strategy<tally_result>();
+    std::cout << "swaps: " << swaps << ", updates: " << tally_result::s_total << " of " << workers * updates
+              << ", calls on destroyed strategies: " << tally<0>::s_dead_calls + tally<1>::s_dead_calls << std::endl;
+
+    auto tuned = std::make_unique<tuned_context_t>();
+    for (int i {0}; i < 200; ++i)
+        tuned->update(1);
+    for (const auto& t_decision : tuned->decisions())
+        std::cout << "call " << t_decision.call << ": strategy " << t_decision.index << std::endl;
+    for (const auto& t_stats : tuned->measurements())
+        std::cout << "calls: " << t_stats.calls << ", mean cycles: " << t_stats.mean << std::endl;
+    const auto led = tuned->current() == 0 ? tuned->get<fade_columns>().leds[0] : tuned->get<fade_rows>().leds[0];
+    std::cout << "led after 200 fades: " << led << std::endl;
+
+    // converges once; drift only follows when the whole machine stays slower for drift_windows windows
+    steady_context_t steady {tuning::options {.reprobe_period = 0}};
+    for (int i {0}; i < 1000000; ++i)
+        steady.update(20);
+    const auto drifts = std::count_if(steady.decisions().begin(), steady.decisions().end(), [](const auto& t_decision) {
+        return t_decision.why == tuning::reason::drift;
+    });
+    std::cout << "steady workload: strategy " << steady.current() << ", drift re-explorations: " << drifts << std::endl;
+
     return 0;
 }
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "../instrument/instrument.h"
+#include "context.h"
+
+namespace tuning {
+
+    using instrument::cycles;
+
+    inline std::string machine_key() {
+        char host[256] {};
+        gethostname(host, sizeof(host) - 1);
+        return std::string(host) + "/" + std::to_string(std::thread::hardware_concurrency());
+    }
+
+    struct options {
+        std::size_t   explore_budget {16};     // timed calls per strategy in one exploration round
+        std::uint64_t reprobe_period {1 << 16}; // calls between forced explorations, 0 - never
+        double        drift_ratio {1.5};       // re-explore when the chosen strategy gets this much slower
+        std::size_t   drift_window {64};       // calls whose fastest one is compared with the baseline
+        std::size_t   drift_windows {4};       // consecutive slow windows which count as drift
+        double        smoothing {0.125};       // weight of a new sample in the moving average
+        std::size_t   history {64};            // kept decisions
+    };
+
+    struct stats {
+        std::uint64_t calls {0};
+        std::uint64_t total {0};  // cycles of all calls
+        double mean {0};          // mean cycles of the last exploration round
+        double average {0};       // moving average of cycles
+    };
+
+    enum class reason {
+        converge,   // exploration finished, the fastest strategy is chosen
+        drift,      // the chosen strategy got slower than the drift_ratio allows
+        reprobe,    // reprobe_period expired
+        load        // the choice is restored from a file
+    };
+
+    struct decision {
+        std::uint64_t call;
+        std::size_t index;
+        reason why;
+    };
+}
+
+// every alternative either has no state or takes the state over from each other one
+template <class T, class... Ts>
+concept IsTunable = std::is_empty_v<T> || (... && (std::is_same_v<T, Ts> || CallOnHandover<T, Ts>));
+
+// Context which measures every update() and picks the fastest strategy itself.
+// All strategies are kept alive; during exploration calls go round-robin to
+// each of them, after that only the fastest one is called.
+//
+// Every update() must see the same state whichever strategy runs it, so a
+// strategy with state needs on_handover(const Other&) for every other
+// alternative. It is called, outside of the measurement, whenever the called
+// strategy differs from the previous one.
+template <class... Ts>
+struct tuned_context {
+    static_assert((IsTunable<Ts, Ts...> && ...), "a strategy with state needs on_handover(const Other&) for every other strategy");
+
+    static constexpr std::size_t count = sizeof...(Ts);
+
+    explicit tuned_context(tuning::options opts = {}) : m_options {opts} {
+        if (m_options.explore_budget == 0)
+            throw std::invalid_argument("tuned_context: explore_budget must be positive");
+        if (m_options.drift_window == 0)
+            throw std::invalid_argument("tuned_context: drift_window must be positive");
+    }
+
+    void update(int ms) {
+        const auto index = m_exploring ? m_round % count : m_current;
+        if (index != m_last) {
+            s_handover[index][m_last](m_strategies);
+            m_last = index;
+        }
+
+        const auto begin = tuning::cycles();
+        s_table[index](m_strategies, ms);
+        const auto spent = tuning::cycles() - begin;
+
+        ++m_calls;
+        auto& t_stats = m_stats[index];
+        ++t_stats.calls;
+        t_stats.total += spent;
+        t_stats.average = t_stats.calls == 1 ? double(spent)
+                        : t_stats.average + m_options.smoothing * (double(spent) - t_stats.average);
+
+        if (m_exploring)
+            explore(index, spent);
+        else
+            exploit(spent);
+    }
+
+    [[nodiscard]] std::size_t current() const noexcept {
+        return m_current;
+    }
+
+    [[nodiscard]] bool is_exploring() const noexcept {
+        return m_exploring;
+    }
+
+    [[nodiscard]] const std::array<tuning::stats, count>& measurements() const noexcept {
+        return m_stats;
+    }
+
+    [[nodiscard]] const std::vector<tuning::decision>& decisions() const noexcept {
+        return m_decisions;
+    }
+
+    template <class U>
+    [[nodiscard]] U& get() noexcept {
+        return std::get<U>(m_strategies);
+    }
+
+    // "<machine key> <strategy set> <index>" per line, other entries of the file are kept
+    bool save(const std::string& path) const {
+        std::vector<std::string> lines;
+        const auto key = file_key();
+        {
+            std::ifstream in {path};
+            for (std::string line; std::getline(in, line);) {
+                if (line.compare(0, key.size() + 1, key + " ") != 0)
+                    lines.push_back(line);
+            }
+        }
+        lines.push_back(key + " " + std::to_string(m_current));
+
+        std::ofstream out {path, std::ios::trunc};
+        for (const auto& line : lines)
+            out << line << '\n';
+        return bool(out);
+    }
+
+    bool load(const std::string& path) {
+        std::ifstream in {path};
+        const auto key = file_key();
+        for (std::string line; std::getline(in, line);) {
+            if (line.compare(0, key.size() + 1, key + " ") != 0)
+                continue;
+            char* end {nullptr};
+            const auto value = line.c_str() + key.size() + 1;
+            const auto index = std::strtoul(value, &end, 10);
+            if (end == value || index >= count)
+                return false;
+            m_current = index;
+            m_exploring = false;
+            m_baseline = 0;
+            m_window_calls = 0;
+            m_slow_windows = 0;
+            m_since_probe = 0;
+            decide(tuning::reason::load);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    using tuple_t = std::tuple<Ts...>;
+    using timeout_t = void (*)(tuple_t&, int);
+
+    template <std::size_t I>
+    static void call_timeout(tuple_t& strategies, int ms) {
+        std::get<I>(strategies).timeout(ms);
+    }
+
+    static constexpr auto s_table = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<timeout_t, count> { &call_timeout<I>... };
+    }(std::index_sequence_for<Ts...>{});
+
+    using handover_t = void (*)(tuple_t&);
+
+    template <std::size_t To, std::size_t From>
+    static void call_handover(tuple_t& strategies) {
+        call_on_handover {}(std::get<To>(strategies), std::get<From>(strategies));
+    }
+
+    // s_handover[to][from]
+    template <std::size_t To>
+    static constexpr auto s_handover_to = []<std::size_t... From>(std::index_sequence<From...>) {
+        return std::array<handover_t, count> { &call_handover<To, From>... };
+    }(std::index_sequence_for<Ts...>{});
+
+    static constexpr auto s_handover = []<std::size_t... To>(std::index_sequence<To...>) {
+        return std::array<std::array<handover_t, count>, count> { s_handover_to<To>... };
+    }(std::index_sequence_for<Ts...>{});
+
+    static std::string file_key() {
+        return tuning::machine_key() + " " + typeid(tuple_t).name();
+    }
+
+    void explore(std::size_t index, std::uint64_t spent) {
+        m_round_total[index] += spent;
+        if (++m_round < count * m_options.explore_budget)
+            return;
+
+        std::size_t best {0};
+        for (std::size_t i {0}; i < count; ++i) {
+            m_stats[i].mean = double(m_round_total[i]) / double(m_options.explore_budget);
+            if (m_stats[i].mean < m_stats[best].mean)
+                best = i;
+        }
+        m_current = best;
+        m_baseline = 0;
+        m_stats[best].average = m_stats[best].mean;
+        m_exploring = false;
+        m_since_probe = 0;
+        decide(tuning::reason::converge);
+    }
+
+    // Interrupts and page faults only ever add time, so the fastest call of a
+    // window ignores them while a real slowdown raises it. The first window
+    // after a decision sets the baseline; drift_windows slow windows in a row
+    // are needed, a short burst of load on the machine is not drift.
+    void exploit(std::uint64_t spent) {
+        ++m_since_probe;
+        m_window_min = m_window_calls++ == 0 ? spent : std::min(m_window_min, spent);
+
+        bool drifted {false};
+        if (m_window_calls == m_options.drift_window) {
+            const auto fastest = double(m_window_min);
+            m_window_calls = 0;
+            if (m_baseline == 0)
+                m_baseline = fastest;
+            else if (fastest > m_baseline * m_options.drift_ratio)
+                drifted = ++m_slow_windows >= m_options.drift_windows;
+            else
+                m_slow_windows = 0;
+        }
+
+        if (drifted)
+            restart(tuning::reason::drift);
+        else if (m_options.reprobe_period != 0 && m_since_probe >= m_options.reprobe_period)
+            restart(tuning::reason::reprobe);
+    }
+
+    void restart(tuning::reason why) {
+        decide(why);
+        m_window_calls = 0;
+        m_slow_windows = 0;
+        m_exploring = true;
+        m_round = 0;
+        m_round_total = {};
+    }
+
+    void decide(tuning::reason why) {
+        if (m_options.history == 0)
+            return;
+        if (m_decisions.size() == m_options.history)
+            m_decisions.erase(m_decisions.begin());
+        m_decisions.push_back({m_calls, m_current, why});
+    }
+
+    tuple_t m_strategies;
+    tuning::options m_options;
+    std::array<tuning::stats, count> m_stats {};
+    std::array<std::uint64_t, count> m_round_total {};
+    std::vector<tuning::decision> m_decisions;
+    std::uint64_t m_calls {0};
+    std::uint64_t m_since_probe {0};
+    std::size_t m_round {0};
+    std::size_t m_current {0};
+    std::size_t m_last {0};     // strategy which holds the current state
+    std::uint64_t m_window_min {0};
+    std::size_t m_window_calls {0};
+    std::size_t m_slow_windows {0};
+    double m_baseline {0};      // fastest call of the first window after a decision
+    bool m_exploring {true};
+};